@@ -66,7 +66,6 @@ from psycopg2 import tz                             # noqa
 # Register default adapters.
 
 from psycopg2 import extensions as _ext
-_ext.register_adapter(tuple, _ext.SQL_IN)
 _ext.register_adapter(type(None), _ext.NoneAdapter)
 
 # Register the Decimal adapter here instead of in the C layer.
@@ -24,8 +24,9 @@
 # License for more details.
 
 from psycopg2.extensions import (
-    new_type, new_array_type, register_type, register_adapter, QuotedString)
+    new_type, new_array_type, register_type, register_adapter, AsIs)
 from psycopg2.compat import text_type
+from psycopg2._psycopg import PYINET, _inet_quote
 
 # The module is imported on register_ipaddress
 ipaddress = None
@@ -64,15 +65,32 @@ def register_ipaddress(conn_or_curs=None):
 
 
 def _make_casters():
-    inet = new_type((869,), 'INET', cast_interface)
-    ainet = new_array_type((1041,), 'INET[]', inet)
+    if _has_tuple_constructors():
+        # the C typecaster creates the objects from the address as number
+        inet = new_type((869,), 'INET', PYINET,
+            (ipaddress.IPv4Interface, ipaddress.IPv6Interface))
+        cidr = new_type((650,), 'CIDR', PYINET,
+            (ipaddress.IPv4Network, ipaddress.IPv6Network))
+    else:
+        inet = new_type((869,), 'INET', cast_interface)
+        cidr = new_type((650,), 'CIDR', cast_network)
 
-    cidr = new_type((650,), 'CIDR', cast_network)
+    ainet = new_array_type((1041,), 'INET[]', inet)
     acidr = new_array_type((651,), 'CIDR[]', cidr)
 
     return [inet, ainet, cidr, acidr]
 
 
+def _has_tuple_constructors():
+    # The (address, prefix) constructors were added in Python 3.5
+    try:
+        ipaddress.IPv4Network((0, 0))
+    except (TypeError, ValueError):
+        return False
+    else:
+        return True
+
+
 def cast_interface(s, cur=None):
     if s is None:
         return None
@@ -87,4 +105,4 @@ def cast_network(s, cur=None):
 
 
 def adapt_ipaddress(obj):
-    return QuotedString(str(obj))
+    return AsIs(_inet_quote(obj))
@@ -30,7 +30,7 @@ extensions importing register_json from extras.
 import json
 import sys
 
-from psycopg2._psycopg import ISQLQuote, QuotedString
+from psycopg2._psycopg import ISQLQuote, QuotedString, PYJSON
 from psycopg2._psycopg import new_type, new_array_type, register_type
 
 
@@ -101,8 +101,8 @@ def register_json(conn_or_curs=None, globally=False, loads=None,
     :param globally: if `!False` register the typecasters only on
         *conn_or_curs*, otherwise register them globally
     :param loads: the function used to parse the data into a Python object. If
-        `!None` use `!json.loads()`, where `!json` is the module chosen
-        according to the Python version (see above)
+        `!None` use a builtin parser, returning the same objects of
+        `!json.loads()`
     :param oid: the OID of the :sql:`json` type if known; If not, it will be
         queried on *conn_or_curs*
     :param array_oid: the OID of the :sql:`json[]` array type if known;
@@ -158,14 +158,16 @@ def register_default_jsonb(conn_or_curs=None, globally=False, loads=None):
 def _create_json_typecasters(oid, array_oid, loads=None, name='JSON'):
     """Create typecasters for json data type."""
     if loads is None:
-        loads = json.loads
+        # parse the data in C, straight from the result
+        JSON = new_type((oid, ), name, PYJSON)
+    else:
+        def typecast_json(s, cur):
+            if s is None:
+                return None
+            return loads(s)
 
-    def typecast_json(s, cur):
-        if s is None:
-            return None
-        return loads(s)
+        JSON = new_type((oid, ), name, typecast_json)
 
-    JSON = new_type((oid, ), name, typecast_json)
     if array_oid is not None:
         JSONARRAY = new_array_type((array_oid, ), "%sARRAY" % name, JSON)
     else:
@@ -27,7 +27,8 @@
 import re
 
 from psycopg2._psycopg import ProgrammingError, InterfaceError
-from psycopg2.extensions import ISQLQuote, adapt, register_adapter
+from psycopg2._psycopg import PYRANGE, _range_quote
+from psycopg2.extensions import ISQLQuote, register_adapter
 from psycopg2.extensions import new_type, new_array_type, register_type
 from psycopg2.compat import string_types
 
@@ -245,6 +246,7 @@ class RangeAdapter(object):
     attribute or override `getquoted()`.
     """
     name = None
+    _conn = None
 
     def __init__(self, adapted):
         self.adapted = adapted
@@ -262,28 +264,17 @@ class RangeAdapter(object):
                 'RangeAdapter must be subclassed overriding its name '
                 'or the getquoted() method')
 
-        r = self.adapted
-        if r.isempty:
-            return b"'empty'::" + self.name.encode('utf8')
+        return _range_quote(self.adapted, self._conn, self.name)
 
-        if r.lower is not None:
-            a = adapt(r.lower)
-            if hasattr(a, 'prepare'):
-                a.prepare(self._conn)
-            lower = a.getquoted()
-        else:
-            lower = b'NULL'
-
-        if r.upper is not None:
-            a = adapt(r.upper)
-            if hasattr(a, 'prepare'):
-                a.prepare(self._conn)
-            upper = a.getquoted()
-        else:
-            upper = b'NULL'
 
-        return self.name.encode('utf8') + b'(' + lower + b', ' + upper \
-            + b", '" + r._bounds.encode('utf8') + b"')"
+def _is_overridden(obj, cls, name):
+    """Return `!True` if the class of *obj* redefines the method *name*."""
+    for c in type(obj).__mro__:
+        if c is cls:
+            return False
+        if name in c.__dict__:
+            return True
+    return False
 
 
 class RangeCaster(object):
@@ -299,7 +290,11 @@ class RangeCaster(object):
 
         name = self.adapter.name or self.adapter.__class__.__name__
 
-        self.typecaster = new_type((oid,), name, self.parse)
+        if _is_overridden(self, RangeCaster, 'parse'):
+            self.typecaster = new_type((oid,), name, self.parse)
+        else:
+            # parse the ranges in C, casting the bounds with the subtype caster
+            self.typecaster = new_type((oid,), name, PYRANGE, self)
 
         if array_oid is not None:
             self.array_typecaster = new_array_type(
@@ -485,26 +480,10 @@ class DateTimeTZRange(Range):
 class NumberRangeAdapter(RangeAdapter):
     """Adapt a range if the subtype doesn't need quotes."""
     def getquoted(self):
-        r = self.adapted
-        if r.isempty:
-            return b"'empty'"
-
-        if not r.lower_inf:
-            # not exactly: we are relying that none of these object is really
-            # quoted (they are numbers). Also, I'm lazy and not preparing the
-            # adapter because I assume encoding doesn't matter for these
-            # objects.
-            lower = adapt(r.lower).getquoted().decode('ascii')
-        else:
-            lower = ''
-
-        if not r.upper_inf:
-            upper = adapt(r.upper).getquoted().decode('ascii')
-        else:
-            upper = ''
-
-        return ("'%s%s,%s%s'" % (
-            r._bounds[0], lower, upper, r._bounds[1])).encode('ascii')
+        # not exactly: we are relying that none of the bounds is really quoted
+        # (they are numbers). Also the adapters are not prepared because the
+        # encoding doesn't matter for these objects.
+        return _range_quote(self.adapted)
 
 
 # TODO: probably won't work with infs, nans and other tricky cases.
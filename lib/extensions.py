@@ -36,10 +36,12 @@ import re as _re
 
 from psycopg2._psycopg import (                             # noqa
     BINARYARRAY, BOOLEAN, BOOLEANARRAY, DATE, DATEARRAY, DATETIMEARRAY,
-    DECIMAL, DECIMALARRAY, FLOAT, FLOATARRAY, INTEGER, INTEGERARRAY,
-    INTERVAL, INTERVALARRAY, LONGINTEGER, LONGINTEGERARRAY, ROWIDARRAY,
+    DECIMAL, DECIMALARRAY, DEC2NUMBER, DEC2NUMBERARRAY,
+    FLOAT, FLOATARRAY, FLOATARRAY_PYARRAY, INTEGER, INTEGERARRAY,
+    INTEGERARRAY_PYARRAY, INTERVAL, INTERVALARRAY, LONGINTEGER,
+    LONGINTEGERARRAY, LONGINTEGERARRAY_PYARRAY, ROWIDARRAY,
     STRINGARRAY, TIME, TIMEARRAY, UNICODE, UNICODEARRAY,
-    AsIs, Binary, Boolean, Float, Int, QuotedString, )
+    AsIs, Binary, Boolean, Float, Int, QuotedString, SQL_IN, )
 
 try:
     from psycopg2._psycopg import (                         # noqa
@@ -107,31 +109,6 @@ def register_adapter(typ, callable):
     adapters[(typ, ISQLQuote)] = callable
 
 
-# The SQL_IN class is the official adapter for tuples starting from 2.0.6.
-class SQL_IN(object):
-    """Adapt any iterable to an SQL quotable object."""
-    def __init__(self, seq):
-        self._seq = seq
-        self._conn = None
-
-    def prepare(self, conn):
-        self._conn = conn
-
-    def getquoted(self):
-        # this is the important line: note how every object in the
-        # list is adapted and then how getquoted() is called on it
-        pobjs = [adapt(o) for o in self._seq]
-        if self._conn is not None:
-            for obj in pobjs:
-                if hasattr(obj, 'prepare'):
-                    obj.prepare(self._conn)
-        qobjs = [o.getquoted() for o in pobjs]
-        return b'(' + b', '.join(qobjs) + b')'
-
-    def __str__(self):
-        return str(self.getquoted())
-
-
 class NoneAdapter(object):
     """Adapt None to NULL.
 
@@ -44,6 +44,9 @@ from psycopg2._psycopg import (                             # noqa
     ReplicationConnection as _replicationConnection,
     ReplicationCursor as _replicationCursor,
     ReplicationMessage)
+from psycopg2._psycopg import (                             # noqa
+    _hstore_quote, PYHSTORE as _PYHSTORE, PYCOMPOSITE as _PYCOMPOSITE,
+    _uuid_quote, PYUUID as _PYUUID)
 
 
 # expose the json adaptation stuff into the module
@@ -54,7 +57,7 @@ from psycopg2._json import (                                # noqa
 # Expose range-related objects
 from psycopg2._range import (                               # noqa
     Range, NumericRange, DateRange, DateTimeRange, DateTimeTZRange,
-    register_range, RangeAdapter, RangeCaster)
+    register_range, RangeAdapter, RangeCaster, _is_overridden)
 
 
 # Expose ipaddress-related objects
@@ -647,7 +650,7 @@ class UUID_adapter(object):
             return self
 
     def getquoted(self):
-        return ("'%s'::uuid" % self._uuid).encode('utf8')
+        return _uuid_quote(self._uuid)
 
     def __str__(self):
         return "'%s'::uuid" % self._uuid
@@ -674,8 +677,8 @@ def register_uuid(oids=None, conn_or_curs=None):
         oid1 = oids
         oid2 = 2951
 
-    _ext.UUID = _ext.new_type((oid1, ), "UUID",
-            lambda data, cursor: data and uuid.UUID(data) or None)
+    # the C typecaster sets the UUID int without parsing the string again
+    _ext.UUID = _ext.new_type((oid1, ), "UUID", _PYUUID)
     _ext.UUIDARRAY = _ext.new_array_type((oid2,), "UUID[]", _ext.UUID)
 
     _ext.register_type(_ext.UUID, conn_or_curs)
@@ -808,38 +811,11 @@ class HstoreAdapter(object):
 
     def _getquoted_8(self):
         """Use the operators available in PG pre-9.0."""
-        if not self.wrapped:
-            return b"''::hstore"
-
-        adapt = _ext.adapt
-        rv = []
-        for k, v in self.wrapped.items():
-            k = adapt(k)
-            k.prepare(self.conn)
-            k = k.getquoted()
-
-            if v is not None:
-                v = adapt(v)
-                v.prepare(self.conn)
-                v = v.getquoted()
-            else:
-                v = b'NULL'
-
-            # XXX this b'ing is painfully inefficient!
-            rv.append(b"(" + k + b" => " + v + b")")
-
-        return b"(" + b'||'.join(rv) + b")"
+        return _hstore_quote(self.wrapped, self.conn, True)
 
     def _getquoted_9(self):
         """Use the hstore(text[], text[]) function."""
-        if not self.wrapped:
-            return b"''::hstore"
-
-        k = _ext.adapt(list(self.wrapped.keys()))
-        k.prepare(self.conn)
-        v = _ext.adapt(list(self.wrapped.values()))
-        v.prepare(self.conn)
-        return b"hstore(" + k.getquoted() + b", " + v.getquoted() + b")"
+        return _hstore_quote(self.wrapped, self.conn)
 
     getquoted = _getquoted_9
 
@@ -981,11 +957,11 @@ def register_hstore(conn_or_curs, globally=False, unicode=False,
         else:
             array_oid = tuple([x for x in array_oid if x])
 
-    # create and register the typecaster
+    # create and register the typecaster, parsing the data in C
     if _sys.version_info[0] < 3 and unicode:
-        cast = HstoreAdapter.parse_unicode
+        from psycopg2._psycopg import PYUNICODEHSTORE as cast
     else:
-        cast = HstoreAdapter.parse
+        cast = _PYHSTORE
 
     HSTORE = _ext.new_type(oid, "HSTORE", cast)
     _ext.register_type(HSTORE, not globally and conn_or_curs or None)
@@ -1014,7 +990,13 @@ class CompositeCaster(object):
         self.attnames = [a[0] for a in attrs]
         self.atttypes = [a[1] for a in attrs]
         self._create_type(name, self.attnames)
-        self.typecaster = _ext.new_type((oid,), name, self.parse)
+        if (_is_overridden(self, CompositeCaster, 'parse')
+                or _is_overridden(self, CompositeCaster, 'tokenize')):
+            self.typecaster = _ext.new_type((oid,), name, self.parse)
+        else:
+            # tokenize and cast the attributes in C, then call make()
+            self.typecaster = _ext.new_type(
+                (oid,), name, _PYCOMPOSITE, self)
         if array_oid:
             self.array_typecaster = _ext.new_array_type(
                 (array_oid,), "%sARRAY" % name, self.typecaster)
@@ -28,10 +28,15 @@ import string
 
 from psycopg2 import extensions as ext
 from psycopg2.compat import string_types
+from psycopg2._psycopg import _compose
 
 
 _formatter = string.Formatter()
 
+# The templates parsed by SQL.format(), by string
+_templates = {}
+_templates_limit = 1024
+
 
 class Composable(object):
     """
@@ -118,10 +123,7 @@ class Composed(Composable):
         return list(self._wrapped)
 
     def as_string(self, context):
-        rv = []
-        for i in self._wrapped:
-            rv.append(i.as_string(context))
-        return ''.join(rv)
+        return _compose(self._wrapped, context)
 
     def __iter__(self):
         return iter(self._wrapped)
@@ -225,34 +227,15 @@ class SQL(Composable):
 
         """
         rv = []
-        autonum = 0
-        for pre, name, spec, conv in _formatter.parse(self._wrapped):
-            if spec:
-                raise ValueError("no format specification supported by SQL")
-            if conv:
-                raise ValueError("no format conversion supported by SQL")
-            if pre:
-                rv.append(SQL(pre))
-
-            if name is None:
-                continue
-
-            if name.isdigit():
-                if autonum:
-                    raise ValueError(
-                        "cannot switch from automatic field numbering to manual")
-                rv.append(args[int(name)])
-                autonum = None
-
-            elif not name:
-                if autonum is None:
-                    raise ValueError(
-                        "cannot switch from manual field numbering to automatic")
-                rv.append(args[autonum])
-                autonum += 1
-
+        for item in _parse_template(self._wrapped):
+            if isinstance(item, SQL):
+                rv.append(item)
+            elif isinstance(item, string_types):
+                rv.append(kwargs[item])
+            elif isinstance(item, tuple):
+                raise item[0](item[1])
             else:
-                rv.append(kwargs[name])
+                rv.append(args[item])
 
         return Composed(rv)
 
@@ -451,6 +434,61 @@ class Placeholder(Composable):
             return "%s"
 
 
+def _parse_template(s):
+    """Return the parts of a `SQL.format()` template.
+
+    The parts are `SQL` snippets, positional arguments indexes and keyword
+    arguments names. A template error is returned as an (exception, message)
+    tuple in the position where it is found, so that it is raised after the
+    arguments preceding it are looked up, as when it wasn't cached.
+    """
+    # unicode and bytes templates are equal on Python 2 but not the same
+    key = type(s), s
+    try:
+        return _templates[key]
+    except KeyError:
+        pass
+
+    rv = []
+    autonum = 0
+    try:
+        for pre, name, spec, conv in _formatter.parse(s):
+            if spec:
+                raise ValueError("no format specification supported by SQL")
+            if conv:
+                raise ValueError("no format conversion supported by SQL")
+            if pre:
+                rv.append(SQL(pre))
+
+            if name is None:
+                continue
+
+            if name.isdigit():
+                if autonum:
+                    raise ValueError(
+                        "cannot switch from automatic field numbering to manual")
+                rv.append(int(name))
+                autonum = None
+
+            elif not name:
+                if autonum is None:
+                    raise ValueError(
+                        "cannot switch from manual field numbering to automatic")
+                rv.append(autonum)
+                autonum += 1
+
+            else:
+                rv.append(name)
+
+    except ValueError as e:
+        rv.append((ValueError, str(e)))
+
+    if len(_templates) >= _templates_limit:
+        _templates.clear()
+    _templates[key] = rv
+    return rv
+
+
 # Literals
 NULL = SQL("NULL")
 DEFAULT = SQL("DEFAULT")
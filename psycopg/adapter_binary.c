@@ -32,6 +32,9 @@
 
 #include <string.h>
 
+/* Release the GIL while encoding values bigger than this */
+#define HEX_NOGIL_THRESHOLD (64 * 1024)
+
 
 /** the quoting code */
 
@@ -45,13 +48,104 @@ binary_escape(unsigned char *from, size_t from_length,
         return PQescapeBytea(from, from_length, to_length);
 }
 
+static const char hex_digits[] = "0123456789abcdef";
+
+/* Write the `len` bytes in `from` into `to` as 2 lowercase hex digits each */
+static void
+binary_to_hex(const unsigned char *from, Py_ssize_t len, char *to)
+{
+    Py_ssize_t i = 0;
+
+#ifdef PSYCOPG_HAVE_SSE2
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i alpha = _mm_set1_epi8('a' - '0' - 10);
+    __m128i v, hi, lo, c1, c2;
+
+    for (; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)(from + i));
+        hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        lo = _mm_and_si128(v, mask);
+
+        /* interleave the nibbles: high first */
+        c1 = _mm_unpacklo_epi8(hi, lo);
+        c2 = _mm_unpackhi_epi8(hi, lo);
+
+        /* nibble to digit: '0' + n, plus the gap up to 'a' if n > 9 */
+        c1 = _mm_add_epi8(_mm_add_epi8(c1, zero),
+            _mm_and_si128(_mm_cmpgt_epi8(c1, nine), alpha));
+        c2 = _mm_add_epi8(_mm_add_epi8(c2, zero),
+            _mm_and_si128(_mm_cmpgt_epi8(c2, nine), alpha));
+
+        _mm_storeu_si128((__m128i *)(to + 2 * i), c1);
+        _mm_storeu_si128((__m128i *)(to + 2 * i + 16), c2);
+    }
+#endif
+
+    for (; i < len; i++) {
+        to[2 * i] = hex_digits[from[i] >> 4];
+        to[2 * i + 1] = hex_digits[from[i] & 0x0F];
+    }
+}
+
+/* Return the bytea literal of `buffer` in hex format.
+ *
+ * The literal is written straight into the returned bytes, so that the
+ * value is not copied around through intermediate buffers.
+ */
+static PyObject *
+binary_quote_hex(connectionObject *conn, const char *buffer, Py_ssize_t len)
+{
+    const char *scs;
+    int eq, std_strings;
+    Py_ssize_t size;
+    PyObject *rv;
+    char *ptr;
+
+    /* backslashes must be doubled with standard_conforming_strings off */
+    scs = PQparameterStatus(conn->pgconn, "standard_conforming_strings");
+    std_strings = (scs && 0 == strcmp(scs, "on"));
+    eq = conn->equote;
+
+    if (len > (PY_SSIZE_T_MAX - 16) / 2) {
+        return PyErr_NoMemory();
+    }
+    /* E'\\x...'::bytea */
+    size = eq + 1 + (std_strings ? 1 : 2) + 1 + 2 * len + 8;
+    if (!(rv = Bytes_FromStringAndSize(NULL, size))) {
+        return NULL;
+    }
+
+    ptr = Bytes_AS_STRING(rv);
+    if (eq) { *ptr++ = 'E'; }
+    *ptr++ = '\'';
+    *ptr++ = '\\';
+    if (!std_strings) { *ptr++ = '\\'; }
+    *ptr++ = 'x';
+
+    if (len < HEX_NOGIL_THRESHOLD) {
+        binary_to_hex((const unsigned char *)buffer, len, ptr);
+    }
+    else {
+        Py_BEGIN_ALLOW_THREADS;
+        binary_to_hex((const unsigned char *)buffer, len, ptr);
+        Py_END_ALLOW_THREADS;
+    }
+    ptr += 2 * len;
+
+    memcpy(ptr, "'::bytea", 8);
+
+    return rv;
+}
+
 #define HAS_BUFFER (PY_MAJOR_VERSION < 3)
 #define HAS_MEMORYVIEW (PY_MAJOR_VERSION > 2 || PY_MINOR_VERSION >= 6)
 
 /* binary_quote - do the quote process on plain and unicode strings */
 
-static PyObject *
-binary_quote(binaryObject *self)
+PyObject *
+binary_quote(PyObject *wrapped, connectionObject *conn)
 {
     char *to = NULL;
     const char *buffer = NULL;
@@ -64,7 +158,7 @@ binary_quote(binaryObject *self)
 #endif
 
     /* Allow Binary(None) to work */
-    if (self->wrapped == Py_None) {
+    if (wrapped == Py_None) {
         Py_INCREF(psyco_null);
         rv = psyco_null;
         goto exit;
@@ -73,8 +167,8 @@ binary_quote(binaryObject *self)
     /* if we got a plain string or a buffer we escape it and save the buffer */
 
 #if HAS_MEMORYVIEW
-    if (PyObject_CheckBuffer(self->wrapped)) {
-        if (0 > PyObject_GetBuffer(self->wrapped, &view, PyBUF_CONTIG_RO)) {
+    if (PyObject_CheckBuffer(wrapped)) {
+        if (0 > PyObject_GetBuffer(wrapped, &view, PyBUF_CONTIG_RO)) {
             goto exit;
         }
         got_view = 1;
@@ -84,8 +178,8 @@ binary_quote(binaryObject *self)
 #endif
 
 #if HAS_BUFFER
-    if (!buffer && (Bytes_Check(self->wrapped) || PyBuffer_Check(self->wrapped))) {
-        if (PyObject_AsReadBuffer(self->wrapped, (const void **)&buffer,
+    if (!buffer && (Bytes_Check(wrapped) || PyBuffer_Check(wrapped))) {
+        if (PyObject_AsReadBuffer(wrapped, (const void **)&buffer,
                                   &buffer_len) < 0) {
             goto exit;
         }
@@ -96,10 +190,16 @@ binary_quote(binaryObject *self)
         goto exit;
     }
 
+    /* servers from 9.0 understand the hex format: encode it ourselves */
+    if (conn && conn->pgconn && conn->server_version >= 90000) {
+        rv = binary_quote_hex(conn, buffer, buffer_len);
+        goto exit;
+    }
+
     /* escape and build quoted buffer */
 
     to = (char *)binary_escape((unsigned char*)buffer, (size_t)buffer_len,
-        &len, self->conn ? ((connectionObject*)self->conn)->pgconn : NULL);
+        &len, conn ? conn->pgconn : NULL);
     if (to == NULL) {
         PyErr_NoMemory();
         goto exit;
@@ -107,7 +207,7 @@ binary_quote(binaryObject *self)
 
     if (len > 0)
         rv = Bytes_FromFormat(
-            (self->conn && ((connectionObject*)self->conn)->equote)
+            (conn && conn->equote)
                 ? "E'%s'::bytea" : "'%s'::bytea" , to);
     else
         rv = Bytes_FromString("''::bytea");
@@ -121,7 +221,7 @@ exit:
     /* if the wrapped object is not bytes or a buffer, this is an error */
     if (!rv && !PyErr_Occurred()) {
         PyErr_Format(PyExc_TypeError, "can't escape %s to binary",
-            Py_TYPE(self->wrapped)->tp_name);
+            Py_TYPE(wrapped)->tp_name);
     }
 
     return rv;
@@ -133,7 +233,8 @@ static PyObject *
 binary_getquoted(binaryObject *self, PyObject *args)
 {
     if (self->buffer == NULL) {
-        self->buffer = binary_quote(self);
+        self->buffer = binary_quote(
+            self->wrapped, (connectionObject *)self->conn);
     }
     Py_XINCREF(self->buffer);
     return self->buffer;
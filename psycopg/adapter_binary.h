@@ -40,6 +40,8 @@ typedef struct {
     PyObject *conn;
 } binaryObject;
 
+HIDDEN PyObject *binary_quote(PyObject *wrapped, connectionObject *conn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,8 @@
 #include <string.h>
 
 
+static PyObject *utcoffset_name = NULL;
+
 int
 psyco_adapter_datetime_init(void)
 {
@@ -46,13 +48,17 @@ psyco_adapter_datetime_init(void)
         PyErr_SetString(PyExc_ImportError, "datetime initialization failed");
         return -1;
     }
+
+    if (!(utcoffset_name = Text_InternFromString("utcoffset"))) {
+        return -1;
+    }
     return 0;
 }
 
 /* datetime_str, datetime_getquoted - return result of quoting */
 
 static PyObject *
-_pydatetime_string_date_time(pydatetimeObject *self)
+_pydatetime_string_date_time(PyObject *wrapped, int type)
 {
     PyObject *rv = NULL;
     PyObject *iso = NULL;
@@ -60,9 +66,9 @@ _pydatetime_string_date_time(pydatetimeObject *self)
 
     /* Select the right PG type to cast into. */
     char *fmt = NULL;
-    switch (self->type) {
+    switch (type) {
     case PSYCO_DATETIME_TIME:
-        tz = PyObject_GetAttrString(self->wrapped, "tzinfo");
+        tz = PyObject_GetAttrString(wrapped, "tzinfo");
         if (!tz) { goto error; }
         fmt = (tz == Py_None) ? "'%s'::time" : "'%s'::timetz";
         Py_DECREF(tz);
@@ -71,7 +77,7 @@ _pydatetime_string_date_time(pydatetimeObject *self)
         fmt = "'%s'::date";
         break;
     case PSYCO_DATETIME_TIMESTAMP:
-        tz = PyObject_GetAttrString(self->wrapped, "tzinfo");
+        tz = PyObject_GetAttrString(wrapped, "tzinfo");
         if (!tz) { goto error; }
         fmt = (tz == Py_None) ? "'%s'::timestamp" : "'%s'::timestamptz";
         Py_DECREF(tz);
@@ -79,7 +85,7 @@ _pydatetime_string_date_time(pydatetimeObject *self)
     }
 
     if (!(iso = psycopg_ensure_bytes(
-            PyObject_CallMethod(self->wrapped, "isoformat", NULL)))) {
+            PyObject_CallMethod(wrapped, "isoformat", NULL)))) {
         goto error;
     }
 
@@ -93,36 +99,290 @@ error:
     return rv;
 }
 
+/* Write `val` as `n` zero-padded digits; return the pointer past them */
+static char *
+_pydatetime_write_digits(char *ptr, int val, int n)
+{
+    int i;
+
+    for (i = n - 1; i >= 0; i--) {
+        ptr[i] = '0' + (val % 10);
+        val /= 10;
+    }
+    return ptr + n;
+}
+
+/* Write hh:mm:ss, and .ffffff if there are microseconds */
+static char *
+_pydatetime_write_time(char *ptr, int hh, int mm, int ss, int us)
+{
+    ptr = _pydatetime_write_digits(ptr, hh, 2);
+    *ptr++ = ':';
+    ptr = _pydatetime_write_digits(ptr, mm, 2);
+    *ptr++ = ':';
+    ptr = _pydatetime_write_digits(ptr, ss, 2);
+    if (us) {
+        *ptr++ = '.';
+        ptr = _pydatetime_write_digits(ptr, us, 6);
+    }
+    return ptr;
+}
+
+/* Write an utcoffset() result as isoformat() does, e.g. +01:00.
+ *
+ * Return NULL if the offset is not one isoformat() would accept: the caller
+ * should call it to raise the error.
+ */
+static char *
+_pydatetime_write_offset(char *ptr, PyObject *offset)
+{
+    PY_LONG_LONG us;
+    int ss;
+
+    if (!PyDelta_Check(offset)) { return NULL; }
+
+    us = ((PY_LONG_LONG)PyDateTime_DELTA_GET_DAYS(offset) * 86400
+        + PyDateTime_DELTA_GET_SECONDS(offset)) * 1000000
+        + PyDateTime_DELTA_GET_MICROSECONDS(offset);
+    if (us < 0) {
+        *ptr++ = '-';
+        us = -us;
+    }
+    else {
+        *ptr++ = '+';
+    }
+    if (us >= (PY_LONG_LONG)86400 * 1000000) { return NULL; }
+
+    ss = (int)(us / 1000000);
+    us %= 1000000;
+#if PY_VERSION_HEX < 0x03070000
+    /* before Python 3.7 the offset is a whole number of minutes */
+    if (us || ss % 60) { return NULL; }
+#endif
+
+    ptr = _pydatetime_write_digits(ptr, ss / 3600, 2);
+    *ptr++ = ':';
+    ptr = _pydatetime_write_digits(ptr, ss / 60 % 60, 2);
+    if (ss % 60 || us) {
+        *ptr++ = ':';
+        ptr = _pydatetime_write_digits(ptr, ss % 60, 2);
+        if (us) {
+            *ptr++ = '.';
+            ptr = _pydatetime_write_digits(ptr, (int)us, 6);
+        }
+    }
+    return ptr;
+}
+
+/* The last fixed offset tzinfo used and its utcoffset() */
+static PyObject *last_tzinfo = NULL;
+static PyObject *last_offset = NULL;
+
+/* The type of psycopg2.tz.FixedOffsetTimezone, Py_None if not available */
+static PyObject *fixed_offset_type = NULL;
+
+/* Return 1 if the utcoffset() of the tzinfo doesn't depend on its argument:
+ * the case of datetime.timezone and psycopg2.tz.FixedOffsetTimezone */
+static int
+_pydatetime_fixed_offset(PyObject *tzinfo)
+{
+    PyObject *tz;
+
+#if PY_VERSION_HEX >= 0x03070000
+    if (Py_TYPE(tzinfo) == Py_TYPE(PyDateTime_TimeZone_UTC)) { return 1; }
+#endif
+
+    if (!fixed_offset_type) {
+        if ((tz = PyImport_ImportModule("psycopg2.tz"))) {
+            fixed_offset_type = PyObject_GetAttrString(
+                tz, "FixedOffsetTimezone");
+            Py_DECREF(tz);
+        }
+        if (!fixed_offset_type) {
+            PyErr_Clear();
+            Py_INCREF(Py_None);
+            fixed_offset_type = Py_None;
+        }
+    }
+
+    return (PyObject *)Py_TYPE(tzinfo) == fixed_offset_type;
+}
+
+/* Return tzinfo.utcoffset(arg).
+ *
+ * The offset of fixed offset timezones is cached, so that timestamps in the
+ * same timezone don't call into Python.
+ */
 static PyObject *
-_pydatetime_string_delta(pydatetimeObject *self)
+_pydatetime_utcoffset(PyObject *tzinfo, PyObject *arg)
 {
-    PyDateTime_Delta *obj = (PyDateTime_Delta*)self->wrapped;
+    PyObject *rv;
 
-    char buffer[8];
-    int i;
-    int a = PyDateTime_DELTA_GET_MICROSECONDS(obj);
+    if (tzinfo == last_tzinfo) {
+        Py_INCREF(last_offset);
+        return last_offset;
+    }
+
+    if (!(rv = PyObject_CallMethodObjArgs(
+            tzinfo, utcoffset_name, arg, NULL))) {
+        return NULL;
+    }
+
+    if (_pydatetime_fixed_offset(tzinfo)) {
+        Py_CLEAR(last_tzinfo);
+        Py_CLEAR(last_offset);
+        Py_INCREF(tzinfo);
+        last_tzinfo = tzinfo;
+        Py_INCREF(rv);
+        last_offset = rv;
+    }
+
+    return rv;
+}
+
+/* Quote a date, time or datetime (not subclasses) reading its fields.
+ *
+ * Return NULL without an exception set if the tzinfo offset is invalid: the
+ * caller should use isoformat() to raise the error.
+ */
+static PyObject *
+_pydatetime_quote_fields(PyObject *wrapped, int type)
+{
+    PyObject *tzinfo = Py_None, *offset = NULL, *rv = NULL;
+    char buf[80], *ptr = buf;
+    const char *cast;
+    size_t clen;
+
+    *ptr++ = '\'';
+
+    if (type == PSYCO_DATETIME_DATE || type == PSYCO_DATETIME_TIMESTAMP) {
+        ptr = _pydatetime_write_digits(ptr, PyDateTime_GET_YEAR(wrapped), 4);
+        *ptr++ = '-';
+        ptr = _pydatetime_write_digits(ptr, PyDateTime_GET_MONTH(wrapped), 2);
+        *ptr++ = '-';
+        ptr = _pydatetime_write_digits(ptr, PyDateTime_GET_DAY(wrapped), 2);
+    }
+
+    switch (type) {
+    case PSYCO_DATETIME_DATE:
+        cast = "'::date";
+        break;
 
-    for (i=0; i < 6 ; i++) {
-        buffer[5-i] = '0' + (a % 10);
-        a /= 10;
+    case PSYCO_DATETIME_TIMESTAMP:
+        *ptr++ = 'T';
+        ptr = _pydatetime_write_time(ptr,
+            PyDateTime_DATE_GET_HOUR(wrapped),
+            PyDateTime_DATE_GET_MINUTE(wrapped),
+            PyDateTime_DATE_GET_SECOND(wrapped),
+            PyDateTime_DATE_GET_MICROSECOND(wrapped));
+        if (((PyDateTime_DateTime *)wrapped)->hastzinfo) {
+            tzinfo = ((PyDateTime_DateTime *)wrapped)->tzinfo;
+        }
+        cast = (tzinfo == Py_None) ? "'::timestamp" : "'::timestamptz";
+        break;
+
+    default:
+        ptr = _pydatetime_write_time(ptr,
+            PyDateTime_TIME_GET_HOUR(wrapped),
+            PyDateTime_TIME_GET_MINUTE(wrapped),
+            PyDateTime_TIME_GET_SECOND(wrapped),
+            PyDateTime_TIME_GET_MICROSECOND(wrapped));
+        if (((PyDateTime_Time *)wrapped)->hastzinfo) {
+            tzinfo = ((PyDateTime_Time *)wrapped)->tzinfo;
+        }
+        cast = (tzinfo == Py_None) ? "'::time" : "'::timetz";
+        break;
     }
-    buffer[6] = '\0';
 
-    return Bytes_FromFormat("'%d days %d.%s seconds'::interval",
-                            PyDateTime_DELTA_GET_DAYS(obj),
-                            PyDateTime_DELTA_GET_SECONDS(obj),
-                            buffer);
+    if (tzinfo != Py_None) {
+        /* time.isoformat() passes None to utcoffset() */
+        if (!(offset = _pydatetime_utcoffset(tzinfo,
+                type == PSYCO_DATETIME_TIMESTAMP ? wrapped : Py_None))) {
+            goto exit;
+        }
+        if (offset != Py_None
+                && !(ptr = _pydatetime_write_offset(ptr, offset))) {
+            goto exit;
+        }
+    }
+
+    clen = strlen(cast);
+    memcpy(ptr, cast, clen);
+    ptr += clen;
+    rv = Bytes_FromStringAndSize(buf, ptr - buf);
+
+exit:
+    Py_XDECREF(offset);
+    return rv;
+}
+
+static PyObject *
+_pydatetime_string_delta(PyObject *wrapped)
+{
+    PyDateTime_Delta *obj = (PyDateTime_Delta*)wrapped;
+    char buf[64];
+    int len;
+
+    len = sprintf(buf, "'%d days %d.%06d seconds'::interval",
+        PyDateTime_DELTA_GET_DAYS(obj),
+        PyDateTime_DELTA_GET_SECONDS(obj),
+        PyDateTime_DELTA_GET_MICROSECONDS(obj));
+
+    return Bytes_FromStringAndSize(buf, len);
+}
+
+PyObject *
+pydatetime_quote(PyObject *wrapped, int type)
+{
+    PyObject *rv;
+
+    if (type > PSYCO_DATETIME_TIMESTAMP) {
+        return _pydatetime_string_delta(wrapped);
+    }
+
+    /* subclasses may have a different isoformat() */
+    if ((type == PSYCO_DATETIME_DATE && PyDate_CheckExact(wrapped))
+            || (type == PSYCO_DATETIME_TIMESTAMP
+                && PyDateTime_CheckExact(wrapped))
+            || (type == PSYCO_DATETIME_TIME && PyTime_CheckExact(wrapped))) {
+        if ((rv = _pydatetime_quote_fields(wrapped, type))
+                || PyErr_Occurred()) {
+            return rv;
+        }
+    }
+
+    return _pydatetime_string_date_time(wrapped, type);
 }
 
 static PyObject *
 pydatetime_getquoted(pydatetimeObject *self, PyObject *args)
 {
-    if (self->type <= PSYCO_DATETIME_TIMESTAMP) {
-        return _pydatetime_string_date_time(self);
+    return pydatetime_quote(self->wrapped, self->type);
+}
+
+/* Return the PSYCO_DATETIME_* type `adapter` would wrap `obj` into if it is
+ * one of the *FromPy functions, else -1 */
+int
+pydatetime_default_type(PyObject *adapter, PyObject *obj)
+{
+    PyCFunction func;
+
+    if (!PyCFunction_Check(adapter)) { return -1; }
+    func = PyCFunction_GET_FUNCTION(adapter);
+
+    if (func == (PyCFunction)psyco_DateFromPy) {
+        return PyDate_Check(obj) ? PSYCO_DATETIME_DATE : -1;
     }
-    else {
-        return _pydatetime_string_delta(self);
+    if (func == (PyCFunction)psyco_TimestampFromPy) {
+        return PyDateTime_Check(obj) ? PSYCO_DATETIME_TIMESTAMP : -1;
+    }
+    if (func == (PyCFunction)psyco_TimeFromPy) {
+        return PyTime_Check(obj) ? PSYCO_DATETIME_TIME : -1;
+    }
+    if (func == (PyCFunction)psyco_IntervalFromPy) {
+        return PyDelta_Check(obj) ? PSYCO_DATETIME_INTERVAL : -1;
     }
+    return -1;
 }
 
 static PyObject *
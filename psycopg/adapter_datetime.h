@@ -47,6 +47,10 @@ typedef struct {
 
 HIDDEN int psyco_adapter_datetime_init(void);
 
+/* the literal of a date/time object of the given PSYCO_DATETIME_* type */
+HIDDEN PyObject *pydatetime_quote(PyObject *wrapped, int type);
+HIDDEN int pydatetime_default_type(PyObject *adapter, PyObject *obj);
+
 /* functions exported to psycopgmodule.c */
 #ifdef PSYCOPG_DEFAULT_PYDATETIME
 
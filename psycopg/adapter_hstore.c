@@ -0,0 +1,276 @@
+/* adapter_hstore.c - quote Python dicts as hstore
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/adapter_hstore.h"
+#include "psycopg/adapter_qstring.h"
+#include "psycopg/microprotocols.h"
+#include "psycopg/microprotocols_proto.h"
+
+#include <string.h>
+
+
+/* A key or a value of the dict: either a string to escape or the result of
+ * its adapter. */
+typedef struct {
+    PyObject *data;
+    int escape;
+} hstorePiece;
+
+/* Return 1 if the objects of `type` are adapted by QuotedString, so that they
+ * can be escaped here without creating the adapter */
+static int
+hstore_quoted_string(PyTypeObject *type)
+{
+    PyObject *key, *adapter;
+
+    if (!(key = PyTuple_Pack(2, (PyObject *)type, (PyObject *)&isqlquoteType))) {
+        return -1;
+    }
+    adapter = PyDict_GetItem(psyco_adapters, key);
+    Py_DECREF(key);
+    return adapter == (PyObject *)&qstringType;
+}
+
+static int
+hstore_piece(hstorePiece *piece, PyObject *obj, connectionObject *conn,
+             int ustr, int bstr)
+{
+    if (obj == Py_None) {
+        Py_INCREF(psyco_null);
+        piece->data = psyco_null;
+    }
+    else if (ustr && PyUnicode_CheckExact(obj)) {
+        if (!(piece->data = conn_encode(conn, obj))) { return -1; }
+        piece->escape = 1;
+    }
+#if PY_MAJOR_VERSION < 3
+    else if (bstr && PyString_CheckExact(obj)) {
+        Py_INCREF(obj);
+        piece->data = obj;
+        piece->escape = 1;
+    }
+#endif
+    else if (!(piece->data = microprotocol_getquoted(obj, conn))) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* The space needed to write a piece */
+static Py_ssize_t
+hstore_piece_size(hstorePiece *piece)
+{
+    Py_ssize_t len = Bytes_GET_SIZE(piece->data);
+
+    /* the room psycopg_escape_string() needs for its worst case */
+    return piece->escape ? len * 2 + 4 : len;
+}
+
+/* Write a piece at `ptr`: return the pointer past it, NULL on error */
+static char *
+hstore_write_piece(char *ptr, hstorePiece *piece, connectionObject *conn)
+{
+    Py_ssize_t len = Bytes_GET_SIZE(piece->data);
+
+    if (piece->escape) {
+        if (!psycopg_escape_string(
+                conn, Bytes_AS_STRING(piece->data), len, ptr, &len)) {
+            return NULL;
+        }
+    }
+    else {
+        memcpy(ptr, Bytes_AS_STRING(piece->data), len);
+    }
+
+    return ptr + len;
+}
+
+/* Write the pieces from `start` every `step` as an array.
+ *
+ * As in the list adapter, use the '{NULL,...}' syntax if they are all NULL.
+ */
+static char *
+hstore_write_array(char *ptr, hstorePiece *pieces, Py_ssize_t n,
+                   Py_ssize_t start, connectionObject *conn)
+{
+    Py_ssize_t i;
+    int all_nulls = 1;
+
+    for (i = start; i < n * 2; i += 2) {
+        if (pieces[i].data != psyco_null) {
+            all_nulls = 0;
+            break;
+        }
+    }
+
+    if (all_nulls) {
+        *ptr++ = '\'';
+        *ptr++ = '{';
+        for (i = start; i < n * 2; i += 2) {
+            memcpy(ptr, "NULL,", 5);
+            ptr += 5;
+        }
+        *(ptr - 1) = '}';
+        *ptr++ = '\'';
+        return ptr;
+    }
+
+    memcpy(ptr, "ARRAY[", 6);
+    ptr += 6;
+    for (i = start; i < n * 2; i += 2) {
+        if (!(ptr = hstore_write_piece(ptr, &pieces[i], conn))) {
+            return NULL;
+        }
+        *ptr++ = ',';
+    }
+    *(ptr - 1) = ']';
+    return ptr;
+}
+
+PyObject *
+psyco_hstore_quote(PyObject *module, PyObject *args)
+{
+    PyObject *wrapped, *pyconn = Py_None;
+    PyObject *dict = NULL, *k, *v, *rv = NULL;
+    connectionObject *conn = NULL;
+    hstorePiece *pieces = NULL;
+    Py_ssize_t n, i, pos = 0, size;
+    int legacy = 0, ustr = 0, bstr = 0;
+    char *ptr;
+
+    if (!PyArg_ParseTuple(args, "O|Oi", &wrapped, &pyconn, &legacy)) {
+        return NULL;
+    }
+
+    if (pyconn != Py_None) {
+        if (!PyObject_TypeCheck(pyconn, &connectionType)) {
+            PyErr_SetString(PyExc_TypeError,
+                "the second argument must be a connection or None");
+            goto exit;
+        }
+        conn = (connectionObject *)pyconn;
+    }
+
+    if (PyDict_Check(wrapped)) {
+        Py_INCREF(wrapped);
+        dict = wrapped;
+    }
+    else if (!(dict = PyObject_CallFunctionObjArgs(
+            (PyObject *)&PyDict_Type, wrapped, NULL))) {
+        goto exit;
+    }
+
+    if (0 == (n = PyDict_Size(dict))) {
+        rv = Bytes_FromString("''::hstore");
+        goto exit;
+    }
+
+    /* the strings are encoded with the connection encoding */
+    if (conn) {
+        if (0 > (ustr = hstore_quoted_string(&PyUnicode_Type))) { goto exit; }
+#if PY_MAJOR_VERSION < 3
+        if (0 > (bstr = hstore_quoted_string(&PyString_Type))) { goto exit; }
+#endif
+    }
+
+    if (!(pieces = PyMem_New(hstorePiece, n * 2))) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    memset(pieces, 0, n * 2 * sizeof(hstorePiece));
+
+    /* adapters may run Python code: don't trust the dict size */
+    size = 0;
+    for (i = 0; i < n && PyDict_Next(dict, &pos, &k, &v); i++) {
+        if (0 > hstore_piece(&pieces[i * 2], k, conn, ustr, bstr)) {
+            goto exit;
+        }
+        if (0 > hstore_piece(&pieces[i * 2 + 1], v, conn, ustr, bstr)) {
+            goto exit;
+        }
+        size += hstore_piece_size(&pieces[i * 2]);
+        size += hstore_piece_size(&pieces[i * 2 + 1]);
+    }
+    n = i;
+
+    /* hstore(ARRAY[...], ARRAY[...]) or ((k => v)||...) */
+    size += legacy ? n * 10 + 2 : n * 2 + 32;
+    if (!(rv = Bytes_FromStringAndSize(NULL, size))) { goto exit; }
+    ptr = Bytes_AS_STRING(rv);
+
+    if (!legacy) {
+        memcpy(ptr, "hstore(", 7);
+        ptr += 7;
+        if (!(ptr = hstore_write_array(ptr, pieces, n, 0, conn))) {
+            goto error;
+        }
+        *ptr++ = ',';
+        *ptr++ = ' ';
+        if (!(ptr = hstore_write_array(ptr, pieces, n, 1, conn))) {
+            goto error;
+        }
+        *ptr++ = ')';
+    }
+    else {
+        *ptr++ = '(';
+        for (i = 0; i < n; i++) {
+            if (i) {
+                *ptr++ = '|';
+                *ptr++ = '|';
+            }
+            *ptr++ = '(';
+            if (!(ptr = hstore_write_piece(ptr, &pieces[i * 2], conn))) {
+                goto error;
+            }
+            memcpy(ptr, " => ", 4);
+            ptr += 4;
+            if (!(ptr = hstore_write_piece(ptr, &pieces[i * 2 + 1], conn))) {
+                goto error;
+            }
+            *ptr++ = ')';
+        }
+        *ptr++ = ')';
+    }
+
+    if (0 > _Bytes_Resize(&rv, ptr - Bytes_AS_STRING(rv))) { goto exit; }
+    goto exit;
+
+error:
+    Py_CLEAR(rv);
+
+exit:
+    if (pieces) {
+        for (i = 0; i < n * 2; i++) {
+            Py_XDECREF(pieces[i].data);
+        }
+        PyMem_Free(pieces);
+    }
+    Py_XDECREF(dict);
+    return rv;
+}
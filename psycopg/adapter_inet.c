@@ -0,0 +1,151 @@
+/* adapter_inet.c - quote ipaddress objects
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/adapter_inet.h"
+
+#include <stdio.h>
+
+
+/* Write the address in `bytes` in the canonical form, the same str() returns.
+ *
+ * Return the number of chars written; `out` must have room for 40 of them.
+ */
+static int
+inet_write_address(char *out, const unsigned char *bytes, int v6)
+{
+    int i, n = 0, run, best = -1, bestlen = 1;
+    unsigned int groups[8];
+
+    if (!v6) {
+        return sprintf(out, "%u.%u.%u.%u",
+            bytes[0], bytes[1], bytes[2], bytes[3]);
+    }
+
+    /* compress the first longest run of more than one zero group */
+    for (i = 0; i < 8; i++) {
+        groups[i] = bytes[i * 2] << 8 | bytes[i * 2 + 1];
+    }
+    for (i = 0; i < 8; i += run ? run : 1) {
+        for (run = 0; i + run < 8 && !groups[i + run]; run++) {}
+        if (run > bestlen) {
+            best = i;
+            bestlen = run;
+        }
+    }
+
+    for (i = 0; i < 8; i++) {
+        if (i == best) {
+            out[n++] = ':';
+            out[n++] = ':';
+            i += bestlen - 1;
+            continue;
+        }
+        if (i && i != best + bestlen) { out[n++] = ':'; }
+        n += sprintf(out + n, "%x", groups[i]);
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/* Quote an ipaddress address, interface or network as a string literal.
+ *
+ * Return a str, so that it can be wrapped into AsIs by adapt_ipaddress().
+ */
+PyObject *
+psyco_inet_quote(PyObject *module, PyObject *args)
+{
+    PyObject *obj, *type, *addr = NULL, *num = NULL, *tmp, *rv = NULL;
+    unsigned char bytes[16];
+    char buf[64];
+    long version, prefix = -1;
+    int n, v6;
+
+    if (!PyArg_ParseTuple(args, "O", &obj)) { return NULL; }
+    type = (PyObject *)Py_TYPE(obj);
+
+    if (!(tmp = PyObject_GetAttrString(obj, "version"))) { goto exit; }
+    version = PyInt_AsLong(tmp);
+    Py_DECREF(tmp);
+    if (version != 4 && version != 6) {
+        if (!PyErr_Occurred()) {
+            PyErr_Format(PyExc_ValueError, "bad ip version: %ld", version);
+        }
+        goto exit;
+    }
+    v6 = (version == 6);
+
+    /* networks are not numbers; interfaces are addresses with a network. Some
+     * of their attributes are set on init: check the methods of the classes */
+    if (PyObject_HasAttrString(type, "hosts")) {
+        if (!(addr = PyObject_GetAttrString(obj, "network_address"))) {
+            goto exit;
+        }
+        if (!(tmp = PyObject_GetAttrString(obj, "prefixlen"))) { goto exit; }
+    }
+    else {
+        Py_INCREF(obj);
+        addr = obj;
+        if (PyObject_HasAttrString(type, "ip")) {
+            PyObject *net;
+            if (!(net = PyObject_GetAttrString(obj, "network"))) {
+                goto exit;
+            }
+            tmp = PyObject_GetAttrString(net, "prefixlen");
+            Py_DECREF(net);
+            if (!tmp) { goto exit; }
+        }
+        else {
+            tmp = NULL;
+        }
+    }
+    if (tmp) {
+        prefix = PyInt_AsLong(tmp);
+        Py_DECREF(tmp);
+        if (prefix == -1 && PyErr_Occurred()) { goto exit; }
+    }
+
+    if (!(num = PyNumber_Long(addr))) { goto exit; }
+    if (0 > psycopg_long_as_bytes(num, bytes, v6 ? 16 : 4)) {
+        goto exit;
+    }
+
+    buf[0] = '\'';
+    n = 1 + inet_write_address(buf + 1, bytes, v6);
+    if (prefix >= 0) {
+        n += sprintf(buf + n, "/%ld", prefix);
+    }
+    buf[n++] = '\'';
+
+    rv = Text_FromUTF8AndSize(buf, n);
+
+exit:
+    Py_XDECREF(num);
+    Py_XDECREF(addr);
+    return rv;
+}
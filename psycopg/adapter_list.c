@@ -27,14 +27,427 @@
 #include "psycopg/psycopg.h"
 
 #include "psycopg/adapter_list.h"
+#include "psycopg/adapter_pint.h"
+#include "psycopg/adapter_pfloat.h"
+#include "psycopg/adapter_qstring.h"
 #include "psycopg/microprotocols.h"
 #include "psycopg/microprotocols_proto.h"
 
+#include <string.h>
+
+
+/* The arrays of numbers and strings are written as a literal in one pass,
+ * without adapting the items: a float array is sent as '{1.5,2.0}'::numeric[]
+ * instead of ARRAY[1.5,2.0]. The type cast is the same the server would
+ * choose for the ARRAY[] of the same items, so the result doesn't change.
+ */
+
+/* the max number of dimensions of a postgres array */
+#define LIST_MAXDIM 6
+
+/* the kind of items found in a list */
+#define LIST_HAS_INT        0x01
+#define LIST_HAS_INT8       0x02
+#define LIST_HAS_FLOAT      0x04
+#define LIST_HAS_NONFINITE  0x08
+#define LIST_HAS_STR        0x10
+
+/* the space reserved for a number, plus the comma */
+#define LIST_NUMBER_SIZE 32
+
+typedef struct {
+    char *buf;
+    Py_ssize_t len;
+    Py_ssize_t size;
+} listBuffer;
+
+/* Make room for `n` more chars in the buffer */
+static int
+list_buffer_reserve(listBuffer *b, Py_ssize_t n)
+{
+    Py_ssize_t size;
+    char *buf;
+
+    if (b->len + n <= b->size) { return 0; }
+
+    size = (b->len + n) * 2;
+    if (!(buf = PyMem_Realloc(b->buf, size))) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    b->buf = buf;
+    b->size = size;
+    return 0;
+}
+
+/* Return 1 if the objects of `type` are adapted by `adapter`, so that they
+ * can be written here without creating it */
+static int
+list_default_adapter(PyTypeObject *type, PyTypeObject *adapter)
+{
+    PyObject *key, *a;
+
+    if (!(key = PyTuple_Pack(2, (PyObject *)type, (PyObject *)&isqlquoteType))) {
+        return -1;
+    }
+    a = PyDict_GetItem(psyco_adapters, key);
+    Py_DECREF(key);
+    return a == (PyObject *)adapter;
+}
+
+/* Check the items of a list at `depth`, adding their kind to `flags`.
+ *
+ * Return 0 if the list can't be written as a literal: if the items are not
+ * all numbers or all strings, or if it's not a rectangular array.
+ */
+static int
+list_scan(PyObject *lst, int depth, int ndim, Py_ssize_t *dims, int *flags)
+{
+    PyObject *item;
+    Py_ssize_t i;
+    PY_LONG_LONG val;
+    int overflow;
+    double d;
+
+    if (PyList_GET_SIZE(lst) != dims[depth]) { return 0; }
+
+    for (i = 0; i < dims[depth]; i++) {
+        item = PyList_GET_ITEM(lst, i);
+        if (depth < ndim - 1) {
+            if (!PyList_CheckExact(item)) { return 0; }
+            if (!list_scan(item, depth + 1, ndim, dims, flags)) { return 0; }
+        }
+        else if (item == Py_None) {
+            continue;
+        }
+#if PY_MAJOR_VERSION < 3
+        else if (PyInt_CheckExact(item)) {
+            val = PyInt_AS_LONG(item);
+            *flags |= (val > INT_MAX || val < INT_MIN)
+                ? LIST_HAS_INT8 : LIST_HAS_INT;
+        }
+#endif
+        else if (PyLong_CheckExact(item)) {
+            val = PyLong_AsLongLongAndOverflow(item, &overflow);
+            if (overflow) { return 0; }
+            *flags |= (val > INT_MAX || val < INT_MIN)
+                ? LIST_HAS_INT8 : LIST_HAS_INT;
+        }
+        else if (PyFloat_CheckExact(item)) {
+            d = PyFloat_AS_DOUBLE(item);
+            *flags |= (isnan(d) || isinf(d))
+                ? LIST_HAS_NONFINITE : LIST_HAS_FLOAT;
+        }
+#if PY_MAJOR_VERSION < 3
+        else if (PyString_CheckExact(item) || PyUnicode_CheckExact(item)) {
+#else
+        else if (PyUnicode_CheckExact(item)) {
+#endif
+            *flags |= LIST_HAS_STR;
+        }
+        else {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Write an item of a number array at the end of the buffer */
+static int
+list_write_number(listBuffer *b, PyObject *item)
+{
+    char *ptr, *num, *a, *z, c;
+    unsigned PY_LONG_LONG uval;
+    PY_LONG_LONG val;
+    Py_ssize_t len;
+    double d;
+
+    if (0 > list_buffer_reserve(b, LIST_NUMBER_SIZE)) { return -1; }
+    ptr = b->buf + b->len;
+
+    if (PyFloat_CheckExact(item)) {
+        d = PyFloat_AS_DOUBLE(item);
+        if (isnan(d)) {
+            memcpy(ptr, "NaN", 3);
+            b->len += 3;
+        }
+        else if (isinf(d)) {
+            len = d > 0 ? 8 : 9;
+            memcpy(ptr, d > 0 ? "Infinity" : "-Infinity", len);
+            b->len += len;
+        }
+        else {
+            /* the same digits as repr() */
+            if (!(num = PyOS_double_to_string(
+                    d, 'r', 0, Py_DTSF_ADD_DOT_0, NULL))) {
+                PyErr_NoMemory();
+                return -1;
+            }
+            len = strlen(num);
+            memcpy(ptr, num, len);
+            b->len += len;
+            PyMem_Free(num);
+        }
+        return 0;
+    }
+
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_CheckExact(item)) {
+        val = PyInt_AS_LONG(item);
+    }
+    else
+#endif
+    {
+        /* the list was scanned already: the value fits */
+        val = PyLong_AsLongLong(item);
+        if (val == -1 && PyErr_Occurred()) { return -1; }
+    }
+
+    if (val < 0) {
+        *ptr++ = '-';
+        uval = (unsigned PY_LONG_LONG)0 - (unsigned PY_LONG_LONG)val;
+    }
+    else {
+        uval = (unsigned PY_LONG_LONG)val;
+    }
+    a = ptr;
+    do {
+        *ptr++ = '0' + (char)(uval % 10);
+        uval /= 10;
+    } while (uval);
+    for (z = ptr - 1; a < z; a++, z--) {
+        c = *a;
+        *a = *z;
+        *z = c;
+    }
+    b->len = ptr - b->buf;
+    return 0;
+}
+
+/* Write an item of a string array at the end of the buffer, double-quoted */
+static int
+list_write_string(listBuffer *b, PyObject *item, connectionObject *conn)
+{
+    PyObject *bytes;
+    const char *s;
+    char *ptr;
+    Py_ssize_t len;
+    int rv = -1;
+
+    /* encode the string as QuotedString would */
+    if (PyUnicode_Check(item)) {
+        bytes = conn ? conn_encode(conn, item)
+            : PyUnicode_AsEncodedString(item, "latin1", NULL);
+        if (!bytes) { return -1; }
+    }
+    else {
+        Py_INCREF(item);
+        bytes = item;
+    }
+
+    s = Bytes_AS_STRING(bytes);
+    len = Bytes_GET_SIZE(bytes);
+    if (0 > list_buffer_reserve(b, len * 2 + 3)) { goto exit; }
+
+    ptr = b->buf + b->len;
+    *ptr++ = '"';
+    for (; len > 0; len--, s++) {
+        if (*s == '"' || *s == '\\') { *ptr++ = '\\'; }
+        *ptr++ = *s;
+    }
+    *ptr++ = '"';
+    b->len = ptr - b->buf;
+    rv = 0;
+
+exit:
+    Py_DECREF(bytes);
+    return rv;
+}
+
+/* Write the {...} literal of a list at `depth` at the end of the buffer */
+static int
+list_write_literal(listBuffer *b, PyObject *lst, int depth, int ndim,
+                   Py_ssize_t *dims, connectionObject *conn)
+{
+    PyObject *item;
+    Py_ssize_t i;
+    int rv;
+
+    if (0 > list_buffer_reserve(b, 1)) { return -1; }
+    b->buf[b->len++] = '{';
+
+    for (i = 0; i < dims[depth]; i++) {
+        /* encoding the strings may run Python code */
+        if (PyList_GET_SIZE(lst) != dims[depth]) {
+            PyErr_SetString(PyExc_RuntimeError,
+                "list changed size during adaptation");
+            return -1;
+        }
+        item = PyList_GET_ITEM(lst, i);
+        Py_INCREF(item);
+        if (depth < ndim - 1) {
+            if (PyList_CheckExact(item)) {
+                rv = list_write_literal(b, item, depth + 1, ndim, dims, conn);
+            }
+            else {
+                PyErr_SetString(PyExc_RuntimeError,
+                    "list changed during adaptation");
+                rv = -1;
+            }
+        }
+        else if (item == Py_None) {
+            if (0 <= (rv = list_buffer_reserve(b, 4))) {
+                memcpy(b->buf + b->len, "NULL", 4);
+                b->len += 4;
+            }
+        }
+        else if (PyFloat_CheckExact(item) || PyLong_CheckExact(item)
+#if PY_MAJOR_VERSION < 3
+                || PyInt_CheckExact(item)
+#endif
+                ) {
+            rv = list_write_number(b, item);
+        }
+        else {
+            rv = list_write_string(b, item, conn);
+        }
+        Py_DECREF(item);
+        if (0 > rv) { return -1; }
+
+        if (0 > list_buffer_reserve(b, 1)) { return -1; }
+        b->buf[b->len++] = ',';
+    }
+
+    /* the lists are not empty: replace the last comma */
+    b->buf[b->len - 1] = '}';
+    return 0;
+}
+
+/* Return the cast for the array of items of `flags`, "" if they are all
+ * NULL, or NULL if the array can't be written as a literal. */
+static const char *
+list_literal_cast(int flags, int int8)
+{
+    int ints, floats, rv;
+
+    ints = flags & (LIST_HAS_INT | LIST_HAS_INT8);
+    floats = flags & (LIST_HAS_FLOAT | LIST_HAS_NONFINITE);
+
+    /* the types may have been registered a different adapter */
+    if (flags & LIST_HAS_STR) {
+        if (ints || floats) { return NULL; }
+        if (1 != (rv = list_default_adapter(&PyUnicode_Type, &qstringType))) {
+            return NULL;
+        }
+#if PY_MAJOR_VERSION < 3
+        if (1 != (rv = list_default_adapter(&PyString_Type, &qstringType))) {
+            return NULL;
+        }
+#endif
+        return "::text[]";
+    }
+
+    if (ints) {
+        if (1 != (rv = list_default_adapter(&PyLong_Type, &pintType))) {
+            return NULL;
+        }
+#if PY_MAJOR_VERSION < 3
+        if (1 != (rv = list_default_adapter(&PyInt_Type, &pintType))) {
+            return NULL;
+        }
+#endif
+    }
+    if (floats) {
+        if (1 != (rv = list_default_adapter(&PyFloat_Type, &pfloatType))) {
+            return NULL;
+        }
+        /* 'NaN'::float makes a float8 array, else numbers are numeric */
+        return (flags & LIST_HAS_NONFINITE) ? "::float8[]" : "::numeric[]";
+    }
+    if (ints) {
+        return (int8 || (flags & LIST_HAS_INT8)) ? "::int8[]" : "::int4[]";
+    }
+
+    return "";
+}
+
+/* Quote a list of numbers or strings as an array literal.
+ *
+ * If `int8` is set write the ints as int8 even if they would fit an int4.
+ *
+ * Return NULL without an exception set if the list is not made only of
+ * numbers, or only of strings, or if it's not a rectangular array: the
+ * caller should adapt it item by item.
+ */
+PyObject *
+list_quote_literal(PyObject *wrapped, connectionObject *conn, int int8)
+{
+    Py_ssize_t dims[LIST_MAXDIM] = {0};
+    PyObject *item, *rv = NULL;
+    listBuffer b = {NULL, 0, 0};
+    char *qbuf = NULL;
+    const char *cast;
+    Py_ssize_t qlen, clen;
+    int ndim = 0, flags = 0;
+
+    /* the dimensions of the array are the ones of its first items */
+    item = wrapped;
+    while (PyList_Check(item)) {
+        if (ndim == LIST_MAXDIM || PyList_GET_SIZE(item) == 0) {
+            return NULL;
+        }
+        dims[ndim++] = PyList_GET_SIZE(item);
+        item = PyList_GET_ITEM(item, 0);
+    }
+
+    if (!list_scan(wrapped, 0, ndim, dims, &flags)) { return NULL; }
+    if (!(cast = list_literal_cast(flags, int8))) {
+        return NULL;
+    }
+    /* the backslashes added to the strings could end up in the middle of a
+     * multibyte char: let libpq escape the items one by one */
+    if ((flags & LIST_HAS_STR) && conn && !conn_is_ascii_safe(conn)) {
+        return NULL;
+    }
+    clen = strlen(cast);
+
+    if (0 > list_buffer_reserve(&b, dims[0] * 8 + 16)) { goto exit; }
+    b.buf[b.len++] = '\'';
+    if (0 > list_write_literal(&b, wrapped, 0, ndim, dims, conn)) {
+        goto exit;
+    }
+
+    if (!(flags & LIST_HAS_STR)) {
+        if (0 > list_buffer_reserve(&b, clen + 1)) { goto exit; }
+        b.buf[b.len++] = '\'';
+        memcpy(b.buf + b.len, cast, clen);
+        b.len += clen;
+        rv = Bytes_FromStringAndSize(b.buf, b.len);
+        goto exit;
+    }
+
+    /* the strings literal must be escaped as a whole */
+    if (0 > list_buffer_reserve(&b, 1)) { goto exit; }
+    b.buf[b.len] = '\0';
+    if (!(qbuf = psycopg_escape_string(conn, b.buf + 1, b.len - 1,
+            NULL, &qlen))) {
+        goto exit;
+    }
+    if (!(rv = Bytes_FromStringAndSize(NULL, qlen + clen))) { goto exit; }
+    memcpy(Bytes_AS_STRING(rv), qbuf, qlen);
+    memcpy(Bytes_AS_STRING(rv) + qlen, cast, clen);
+
+exit:
+    PyMem_Free(qbuf);
+    PyMem_Free(b.buf);
+    return rv;
+}
 
 /* list_str, list_getquoted - return result of quoting */
 
-static PyObject *
-list_quote(listObject *self)
+PyObject *
+list_quote(PyObject *wrapped, connectionObject *conn)
 {
     /*  adapt the list by calling adapt() recursively and then wrapping
         everything into "ARRAY[]" */
@@ -50,7 +463,7 @@ list_quote(listObject *self)
 
     Py_ssize_t i, len;
 
-    len = PyList_GET_SIZE(self->wrapped);
+    len = PyList_GET_SIZE(wrapped);
 
     /* empty arrays are converted to NULLs (still searching for a way to
        insert an empty array in postgresql */
@@ -61,6 +474,10 @@ list_quote(listObject *self)
         goto exit;
     }
 
+    if ((res = list_quote_literal(wrapped, conn, 0)) || PyErr_Occurred()) {
+        goto exit;
+    }
+
     if (!(qs = PyMem_New(PyObject *, len))) {
         PyErr_NoMemory();
         goto exit;
@@ -68,21 +485,23 @@ list_quote(listObject *self)
     memset(qs, 0, len * sizeof(PyObject *));
 
     for (i = 0; i < len; i++) {
-        PyObject *wrapped = PyList_GET_ITEM(self->wrapped, i);
-        if (wrapped == Py_None) {
+        PyObject *item = PyList_GET_ITEM(wrapped, i);
+        if (item == Py_None) {
             Py_INCREF(psyco_null);
             qs[i] = psyco_null;
         }
         else {
-            if (!(qs[i] = microprotocol_getquoted(
-                    wrapped, (connectionObject*)self->connection))) {
+            if (!(qs[i] = microprotocol_getquoted(item, conn))) {
                 goto exit;
             }
 
             /* Lists of arrays containing only nulls are also not supported
-             * by the ARRAY construct so we should do some special casing */
-            if (PyList_Check(wrapped)) {
-                if (Bytes_AS_STRING(qs[i])[0] == 'A') {
+             * by the ARRAY construct so we should do some special casing.
+             * The literals with a cast are not nulls. */
+            if (PyList_Check(item)) {
+                if (Bytes_AS_STRING(qs[i])[0] == 'A'
+                        || Bytes_AS_STRING(qs[i])[
+                            Bytes_GET_SIZE(qs[i]) - 1] == ']') {
                     all_nulls = 0;
                 }
                 else if (0 == strcmp(Bytes_AS_STRING(qs[i]), "'{}'")) {
@@ -161,15 +580,15 @@ exit:
 }
 
 static PyObject *
-list_str(listObject *self)
+list_getquoted(listObject *self, PyObject *args)
 {
-    return psycopg_ensure_text(list_quote(self));
+    return list_quote(self->wrapped, (connectionObject *)self->connection);
 }
 
 static PyObject *
-list_getquoted(listObject *self, PyObject *args)
+list_str(listObject *self)
 {
-    return list_quote(self);
+    return psycopg_ensure_text(list_getquoted(self, NULL));
 }
 
 static PyObject *
@@ -39,6 +39,10 @@ typedef struct {
     PyObject *connection;
 } listObject;
 
+HIDDEN PyObject *list_quote(PyObject *wrapped, connectionObject *conn);
+HIDDEN PyObject *list_quote_literal(PyObject *wrapped, connectionObject *conn,
+                                    int int8);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,10 +34,10 @@
 
 /** the Boolean object **/
 
-static PyObject *
-pboolean_getquoted(pbooleanObject *self, PyObject *args)
+PyObject *
+pboolean_quote(PyObject *wrapped)
 {
-    if (PyObject_IsTrue(self->wrapped)) {
+    if (PyObject_IsTrue(wrapped)) {
         return Bytes_FromString("true");
     }
     else {
@@ -45,6 +45,12 @@ pboolean_getquoted(pbooleanObject *self, PyObject *args)
     }
 }
 
+static PyObject *
+pboolean_getquoted(pbooleanObject *self, PyObject *args)
+{
+    return pboolean_quote(self->wrapped);
+}
+
 static PyObject *
 pboolean_str(pbooleanObject *self)
 {
@@ -40,6 +40,8 @@ typedef struct {
 
 } pbooleanObject;
 
+HIDDEN PyObject *pboolean_quote(PyObject *wrapped);
+
 #ifdef __cplusplus
 }
 #endif
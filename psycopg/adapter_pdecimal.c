@@ -35,13 +35,22 @@
 
 /** the Decimal object **/
 
-static PyObject *
-pdecimal_getquoted(pdecimalObject *self, PyObject *args)
+static PyObject *is_finite_name = NULL;
+
+PyObject *
+pdecimal_quote(PyObject *wrapped)
 {
     PyObject *check, *res = NULL;
-    check = PyObject_CallMethod(self->wrapped, "is_finite", NULL);
+
+    if (!is_finite_name) {
+        if (!(is_finite_name = Text_InternFromString("is_finite"))) {
+            return NULL;
+        }
+    }
+
+    check = psyco_CallMethodNoArgs(wrapped, is_finite_name);
     if (check == Py_True) {
-        if (!(res = PyObject_Str(self->wrapped))) {
+        if (!(res = PyObject_Str(wrapped))) {
             goto end;
         }
         goto output;
@@ -55,7 +64,7 @@ pdecimal_getquoted(pdecimalObject *self, PyObject *args)
      * We assume we are here because we didn't find the method. */
     PyErr_Clear();
 
-    if (!(check = PyObject_CallMethod(self->wrapped, "_isnan", NULL))) {
+    if (!(check = PyObject_CallMethod(wrapped, "_isnan", NULL))) {
         goto end;
     }
     if (PyObject_IsTrue(check)) {
@@ -64,7 +73,7 @@ pdecimal_getquoted(pdecimalObject *self, PyObject *args)
     }
 
     Py_DECREF(check);
-    if (!(check = PyObject_CallMethod(self->wrapped, "_isinfinity", NULL))) {
+    if (!(check = PyObject_CallMethod(wrapped, "_isinfinity", NULL))) {
         goto end;
     }
     if (PyObject_IsTrue(check)) {
@@ -73,7 +82,7 @@ pdecimal_getquoted(pdecimalObject *self, PyObject *args)
     }
 
     /* wrapped is finite */
-    if (!(res = PyObject_Str(self->wrapped))) {
+    if (!(res = PyObject_Str(wrapped))) {
         goto end;
     }
 
@@ -110,6 +119,12 @@ end:
     return res;
 }
 
+static PyObject *
+pdecimal_getquoted(pdecimalObject *self, PyObject *args)
+{
+    return pdecimal_quote(self->wrapped);
+}
+
 static PyObject *
 pdecimal_str(pdecimalObject *self)
 {
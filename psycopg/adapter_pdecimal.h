@@ -40,6 +40,8 @@ typedef struct {
 
 } pdecimalObject;
 
+HIDDEN PyObject *pdecimal_quote(PyObject *wrapped);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,15 +31,19 @@
 
 #include <floatobject.h>
 #include <math.h>
+#include <string.h>
 
 
 /** the Float object **/
 
-static PyObject *
-pfloat_getquoted(pfloatObject *self, PyObject *args)
+/* pfloat_quote - return the literal of a float, with the space in front of the
+ * negative numbers (ticket #57) */
+
+PyObject *
+pfloat_quote(PyObject *wrapped)
 {
     PyObject *rv;
-    double n = PyFloat_AsDouble(self->wrapped);
+    double n = PyFloat_AsDouble(wrapped);
     if (isnan(n))
         rv = Bytes_FromString("'NaN'::float");
     else if (isinf(n)) {
@@ -48,8 +52,26 @@ pfloat_getquoted(pfloatObject *self, PyObject *args)
         else
             rv = Bytes_FromString("'-Infinity'::float");
     }
+    else if (PyFloat_CheckExact(wrapped)) {
+        /* the same repr() returns, without the unicode round trip */
+        char *buf, *ptr;
+        size_t len;
+        int neg;
+        if (!(buf = PyOS_double_to_string(
+                n, 'r', 0, Py_DTSF_ADD_DOT_0, NULL))) {
+            return PyErr_NoMemory();
+        }
+        len = strlen(buf);
+        neg = (buf[0] == '-');
+        if ((rv = Bytes_FromStringAndSize(NULL, len + neg))) {
+            ptr = Bytes_AS_STRING(rv);
+            if (neg) { *ptr++ = ' '; }
+            memcpy(ptr, buf, len);
+        }
+        PyMem_Free(buf);
+    }
     else {
-        if (!(rv = PyObject_Repr(self->wrapped))) {
+        if (!(rv = PyObject_Repr(wrapped))) {
             goto exit;
         }
 
@@ -83,6 +105,12 @@ exit:
     return rv;
 }
 
+static PyObject *
+pfloat_getquoted(pfloatObject *self, PyObject *args)
+{
+    return pfloat_quote(self->wrapped);
+}
+
 static PyObject *
 pfloat_str(pfloatObject *self)
 {
@@ -40,6 +40,8 @@ typedef struct {
 
 } pfloatObject;
 
+HIDDEN PyObject *pfloat_quote(PyObject *wrapped);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,23 +32,56 @@
 
 /** the Int object **/
 
-static PyObject *
-pint_getquoted(pintObject *self, PyObject *args)
+/* pint_quote - return the literal of an int, with the space in front of the
+ * negative numbers (ticket #57) */
+
+PyObject *
+pint_quote(PyObject *wrapped)
 {
     PyObject *res = NULL;
+    PY_LONG_LONG val;
+    int overflow;
+    char buf[32];
+
+    /* the common case: format the number without creating its str */
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_CheckExact(wrapped)) {
+        val = PyInt_AS_LONG(wrapped);
+        overflow = 0;
+    }
+    else
+#endif
+    if (PyLong_CheckExact(wrapped)) {
+        val = PyLong_AsLongLongAndOverflow(wrapped, &overflow);
+        if (val == -1 && PyErr_Occurred()) { goto exit; }
+    }
+    else {
+        overflow = 1;
+    }
+    if (!overflow) {
+        char *ptr = buf + sizeof(buf);
+        unsigned PY_LONG_LONG uval = val < 0 ?
+            (unsigned PY_LONG_LONG)0 - (unsigned PY_LONG_LONG)val
+            : (unsigned PY_LONG_LONG)val;
+        do {
+            *--ptr = '0' + (char)(uval % 10);
+            uval /= 10;
+        } while (uval);
+        if (val < 0) {
+            *--ptr = '-';
+            *--ptr = ' ';
+        }
+        return Bytes_FromStringAndSize(ptr, buf + sizeof(buf) - ptr);
+    }
 
     /* Convert subclass to int to handle IntEnum and other subclasses
      * whose str() is not the number. */
-    if (PyLong_CheckExact(self->wrapped)
-#if PY_MAJOR_VERSION < 2
-        || PyInt_CheckExact(self->wrapped)
-#endif
-       ) {
-        res = PyObject_Str(self->wrapped);
+    if (PyLong_CheckExact(wrapped)) {
+        res = PyObject_Str(wrapped);
     } else {
         PyObject *tmp;
         if (!(tmp = PyObject_CallFunctionObjArgs(
-                (PyObject *)&PyLong_Type, self->wrapped, NULL))) {
+                (PyObject *)&PyLong_Type, wrapped, NULL))) {
             goto exit;
         }
         res = PyObject_Str(tmp);
@@ -88,6 +121,12 @@ exit:
     return res;
 }
 
+static PyObject *
+pint_getquoted(pintObject *self, PyObject *args)
+{
+    return pint_quote(self->wrapped);
+}
+
 static PyObject *
 pint_str(pintObject *self)
 {
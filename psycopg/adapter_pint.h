@@ -40,6 +40,8 @@ typedef struct {
 
 } pintObject;
 
+HIDDEN PyObject *pint_quote(PyObject *wrapped);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,24 +34,109 @@
 
 static const char *default_encoding = "latin1";
 
-/* qstring_quote - do the quote process on plain and unicode strings */
+/* The result of qstring_scan() */
+#define QSTRING_PLAIN   0       /* only ascii chars not to escape */
+#define QSTRING_HIGHBIT 1       /* chars with the high bit set too */
+#define QSTRING_ESCAPE  2       /* quotes, backslashes or NULs */
 
+/* word-at-a-time helpers: ONES has 0x01 in each byte, HIGHS has 0x80 */
+#define QSTRING_ONES (~(size_t)0 / 0xFF)
+#define QSTRING_HIGHS (QSTRING_ONES * 0x80)
+#define QSTRING_HAS_ZERO(w) (((w) - QSTRING_ONES) & ~(w) & QSTRING_HIGHS)
+
+/* Check if the string contains chars to escape.
+ *
+ * Most strings need no escape: scan them 16 bytes at time using SSE2 where
+ * available, then a word at time, looking for quotes, backslashes and NULs,
+ * and for chars outside the ascii range.
+ */
+static int
+qstring_scan(const char *s, Py_ssize_t len)
+{
+    const size_t quotes = QSTRING_ONES * '\'';
+    const size_t slashes = QSTRING_ONES * '\\';
+    const char *end = s + len;
+    size_t w, high = 0;
+
+#ifdef PSYCOPG_HAVE_SSE2
+    {
+        const __m128i vquotes = _mm_set1_epi8('\'');
+        const __m128i vslashes = _mm_set1_epi8('\\');
+        const __m128i vzeros = _mm_setzero_si128();
+        __m128i v, vhigh = _mm_setzero_si128();
+
+        for (; end - s >= 16; s += 16) {
+            v = _mm_loadu_si128((const __m128i *)s);
+            if (_mm_movemask_epi8(_mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, vquotes),
+                        _mm_cmpeq_epi8(v, vslashes)),
+                    _mm_cmpeq_epi8(v, vzeros)))) {
+                return QSTRING_ESCAPE;
+            }
+            vhigh = _mm_or_si128(vhigh, v);
+        }
+        if (_mm_movemask_epi8(vhigh)) { high = QSTRING_HIGHS; }
+    }
+#endif
+
+    for (; end - s >= (Py_ssize_t)sizeof(size_t); s += sizeof(size_t)) {
+        memcpy(&w, s, sizeof(size_t));
+        if (QSTRING_HAS_ZERO(w) || QSTRING_HAS_ZERO(w ^ quotes)
+                || QSTRING_HAS_ZERO(w ^ slashes)) {
+            return QSTRING_ESCAPE;
+        }
+        high |= w;
+    }
+    for (; s < end; s++) {
+        if (*s == '\'' || *s == '\\' || *s == '\0') {
+            return QSTRING_ESCAPE;
+        }
+        high |= (unsigned char)*s;
+    }
+
+    return (high & QSTRING_HIGHS) ? QSTRING_HIGHBIT : QSTRING_PLAIN;
+}
+
+/* Quote a string not containing chars to escape as 'string' */
 static PyObject *
-qstring_quote(qstringObject *self)
+qstring_quote_plain(const char *s, Py_ssize_t len, connectionObject *conn)
+{
+    PyObject *rv;
+    char *ptr;
+    int eq = (conn && conn->equote) ? 1 : 0;
+
+    if (!(rv = Bytes_FromStringAndSize(NULL, len + eq + 2))) {
+        return NULL;
+    }
+    ptr = Bytes_AS_STRING(rv);
+    if (eq) { *ptr++ = 'E'; }
+    *ptr++ = '\'';
+    memcpy(ptr, s, len);
+    ptr[len] = '\'';
+    return rv;
+}
+
+/* qstring_quote - do the quote process on plain and unicode strings
+ *
+ * Unicode strings are encoded in the connection encoding or, without a
+ * connection, in `encoding` (latin1 if NULL).
+ */
+
+PyObject *
+qstring_quote(PyObject *wrapped, connectionObject *conn, const char *encoding)
 {
     PyObject *str = NULL;
     char *s, *buffer = NULL;
     Py_ssize_t len, qlen;
-    const char *encoding;
     PyObject *rv = NULL;
 
-    if (PyUnicode_Check(self->wrapped)) {
-        if (self->conn) {
-            if (!(str = conn_encode(self->conn, self->wrapped))) { goto exit; }
+    if (PyUnicode_Check(wrapped)) {
+        if (conn) {
+            if (!(str = conn_encode(conn, wrapped))) { goto exit; }
         }
         else {
-            encoding = self->encoding ? self->encoding : default_encoding;
-            if(!(str = PyUnicode_AsEncodedString(self->wrapped, encoding, NULL))) {
+            if (!(str = PyUnicode_AsEncodedString(wrapped,
+                    encoding ? encoding : default_encoding, NULL))) {
                 goto exit;
             }
         }
@@ -59,8 +144,8 @@ qstring_quote(qstringObject *self)
 
     /* if the wrapped object is a binary string, we don't know how to
        (re)encode it, so we pass it as-is */
-    else if (Bytes_Check(self->wrapped)) {
-        str = self->wrapped;
+    else if (Bytes_Check(wrapped)) {
+        str = wrapped;
         /* INCREF to make it ref-wise identical to unicode one */
         Py_INCREF(str);
     }
@@ -71,9 +156,23 @@ qstring_quote(qstringObject *self)
         goto exit;
     }
 
-    /* encode the string into buffer */
+    /* the strings with nothing to escape don't need libpq. The chars out of
+     * the ascii range are fine if we encoded them in a safe encoding. */
     Bytes_AsStringAndSize(str, &s, &len);
-    if (!(buffer = psycopg_escape_string(self->conn, s, len, NULL, &qlen))) {
+    switch (qstring_scan(s, len)) {
+    case QSTRING_PLAIN:
+        rv = qstring_quote_plain(s, len, conn);
+        goto exit;
+    case QSTRING_HIGHBIT:
+        if (conn && str != wrapped && conn_is_ascii_safe(conn)) {
+            rv = qstring_quote_plain(s, len, conn);
+            goto exit;
+        }
+        break;
+    }
+
+    /* encode the string into buffer */
+    if (!(buffer = psycopg_escape_string(conn, s, len, NULL, &qlen))) {
         goto exit;
     }
 
@@ -98,7 +197,8 @@ static PyObject *
 qstring_getquoted(qstringObject *self, PyObject *args)
 {
     if (self->buffer == NULL) {
-        self->buffer = qstring_quote(self);
+        self->buffer = qstring_quote(
+            self->wrapped, self->conn, self->encoding);
     }
     Py_XINCREF(self->buffer);
     return self->buffer;
@@ -44,6 +44,9 @@ typedef struct {
 
 } qstringObject;
 
+HIDDEN PyObject *qstring_quote(
+    PyObject *wrapped, connectionObject *conn, const char *encoding);
+
 #ifdef __cplusplus
 }
 #endif
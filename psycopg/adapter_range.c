@@ -0,0 +1,158 @@
+/* adapter_range.c - quote Range objects
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/adapter_range.h"
+#include "psycopg/microprotocols.h"
+
+#include <string.h>
+
+
+/* Return the quoted bound, or `null` if the bound is None */
+static PyObject *
+range_quote_bound(PyObject *r, const char *attr, connectionObject *conn,
+                  const char *null)
+{
+    PyObject *bound, *rv;
+
+    if (!(bound = PyObject_GetAttrString(r, attr))) { return NULL; }
+
+    if (bound == Py_None) {
+        rv = Bytes_FromString(null);
+    }
+    else {
+        rv = microprotocol_getquoted(bound, conn);
+    }
+
+    Py_DECREF(bound);
+    return rv;
+}
+
+/* Quote a Range as name(lower, upper, 'bounds') if `name` is given, else as
+ * a '[lower,upper)' literal, only valid if the bounds don't need quotes. */
+PyObject *
+psyco_range_quote(PyObject *module, PyObject *args)
+{
+    PyObject *r, *pyconn = Py_None, *name = Py_None;
+    PyObject *bounds = NULL, *lower = NULL, *upper = NULL, *bname = NULL;
+    PyObject *rv = NULL;
+    connectionObject *conn = NULL;
+    Py_ssize_t nlen = 0, llen, ulen;
+    const char *b;
+    char *ptr;
+
+    if (!PyArg_ParseTuple(args, "O|OO", &r, &pyconn, &name)) {
+        return NULL;
+    }
+
+    if (pyconn != Py_None) {
+        if (!PyObject_TypeCheck(pyconn, &connectionType)) {
+            PyErr_SetString(PyExc_TypeError,
+                "the second argument must be a connection or None");
+            goto exit;
+        }
+        conn = (connectionObject *)pyconn;
+    }
+
+    if (name != Py_None) {
+        Py_INCREF(name);
+        if (!(bname = psycopg_ensure_bytes(name))) { goto exit; }
+        nlen = Bytes_GET_SIZE(bname);
+    }
+
+    if (!(bounds = PyObject_GetAttrString(r, "_bounds"))) { goto exit; }
+
+    if (bounds == Py_None) {
+        if (!(rv = Bytes_FromStringAndSize(NULL, nlen + 9))) { goto exit; }
+        ptr = Bytes_AS_STRING(rv);
+        memcpy(ptr, "'empty'::", 9);
+        if (bname) {
+            memcpy(ptr + 9, Bytes_AS_STRING(bname), nlen);
+        }
+        else if (0 > _Bytes_Resize(&rv, 7)) {
+            goto exit;
+        }
+        goto exit;
+    }
+
+    if (!(bounds = psycopg_ensure_bytes(bounds))) { goto exit; }
+    if (Bytes_GET_SIZE(bounds) != 2) {
+        PyErr_SetString(PyExc_ValueError, "bound flags not valid");
+        goto exit;
+    }
+    b = Bytes_AS_STRING(bounds);
+
+    /* the literal has no room for NULL: infinite bounds are empty */
+    if (!(lower = range_quote_bound(r, "_lower", conn, bname ? "NULL" : ""))) {
+        goto exit;
+    }
+    if (!(upper = range_quote_bound(r, "_upper", conn, bname ? "NULL" : ""))) {
+        goto exit;
+    }
+    llen = Bytes_GET_SIZE(lower);
+    ulen = Bytes_GET_SIZE(upper);
+
+    if (bname) {
+        /* name(lower, upper, '[)') */
+        if (!(rv = Bytes_FromStringAndSize(NULL, nlen + llen + ulen + 10))) {
+            goto exit;
+        }
+        ptr = Bytes_AS_STRING(rv);
+        memcpy(ptr, Bytes_AS_STRING(bname), nlen); ptr += nlen;
+        *ptr++ = '(';
+        memcpy(ptr, Bytes_AS_STRING(lower), llen); ptr += llen;
+        *ptr++ = ',';
+        *ptr++ = ' ';
+        memcpy(ptr, Bytes_AS_STRING(upper), ulen); ptr += ulen;
+        memcpy(ptr, ", '", 3); ptr += 3;
+        *ptr++ = b[0];
+        *ptr++ = b[1];
+        *ptr++ = '\'';
+        *ptr++ = ')';
+    }
+    else {
+        /* '[lower,upper)' */
+        if (!(rv = Bytes_FromStringAndSize(NULL, llen + ulen + 5))) {
+            goto exit;
+        }
+        ptr = Bytes_AS_STRING(rv);
+        *ptr++ = '\'';
+        *ptr++ = b[0];
+        memcpy(ptr, Bytes_AS_STRING(lower), llen); ptr += llen;
+        *ptr++ = ',';
+        memcpy(ptr, Bytes_AS_STRING(upper), ulen); ptr += ulen;
+        *ptr++ = b[1];
+        *ptr++ = '\'';
+    }
+
+exit:
+    Py_XDECREF(upper);
+    Py_XDECREF(lower);
+    Py_XDECREF(bounds);
+    Py_XDECREF(bname);
+    return rv;
+}
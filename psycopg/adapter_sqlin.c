@@ -0,0 +1,297 @@
+/* adapter_sqlin.c - adapt sequences to SQL IN lists
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/adapter_sqlin.h"
+#include "psycopg/adapter_list.h"
+#include "psycopg/microprotocols.h"
+#include "psycopg/microprotocols_proto.h"
+
+#include <string.h>
+
+
+/* Quote the items as (item, item, ...) */
+static PyObject *
+sqlin_quote_list(PyObject *tup, connectionObject *conn)
+{
+    PyObject **qs = NULL, *item, *rv = NULL;
+    Py_ssize_t len, i, size, ql;
+    char *ptr;
+
+    len = PyTuple_GET_SIZE(tup);
+    if (!(qs = PyMem_New(PyObject *, len + 1))) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    memset(qs, 0, (len + 1) * sizeof(PyObject *));
+
+    size = 2;
+    for (i = 0; i < len; i++) {
+        item = PyTuple_GET_ITEM(tup, i);
+        if (item == Py_None) {
+            Py_INCREF(psyco_null);
+            qs[i] = psyco_null;
+        }
+        else if (!(qs[i] = microprotocol_getquoted(item, conn))) {
+            goto exit;
+        }
+        size += Bytes_GET_SIZE(qs[i]) + 2;      /* this, and a ', ' */
+    }
+
+    if (!(rv = Bytes_FromStringAndSize(NULL, len ? size - 2 : size))) {
+        goto exit;
+    }
+    ptr = Bytes_AS_STRING(rv);
+    *ptr++ = '(';
+    for (i = 0; i < len; i++) {
+        if (i) {
+            *ptr++ = ',';
+            *ptr++ = ' ';
+        }
+        ql = Bytes_GET_SIZE(qs[i]);
+        memcpy(ptr, Bytes_AS_STRING(qs[i]), ql);
+        ptr += ql;
+    }
+    *ptr = ')';
+
+exit:
+    if (qs) {
+        for (i = 0; i < len; i++) {
+            Py_XDECREF(qs[i]);
+        }
+        PyMem_Free(qs);
+    }
+    return rv;
+}
+
+/* Quote a sequence as an IN list or, if `array`, as an array for ANY().
+ *
+ * The arrays of numbers or strings are written as literals; the ints as int8,
+ * so that the query is the same for every sequence of ints. The empty and
+ * all-None sequences have no item to choose a type from: they are written as
+ * the untyped '{}' and '{NULL,...}', which take the type of the other operand.
+ */
+PyObject *
+sqlin_quote(PyObject *wrapped, connectionObject *conn, int array)
+{
+    PyObject *tup = NULL, *lst = NULL, *rv = NULL;
+
+    if (!array) {
+        if (!(tup = PySequence_Tuple(wrapped))) { goto exit; }
+        rv = sqlin_quote_list(tup, conn);
+        goto exit;
+    }
+
+    if (!(lst = PySequence_List(wrapped))) { goto exit; }
+    if ((rv = list_quote_literal(lst, conn, 1)) || PyErr_Occurred()) {
+        goto exit;
+    }
+    rv = list_quote(lst, conn);
+
+exit:
+    Py_XDECREF(lst);
+    Py_XDECREF(tup);
+    return rv;
+}
+
+
+/* sqlin_str, sqlin_getquoted - return result of quoting */
+
+static PyObject *
+sqlin_getquoted(sqlinObject *self, PyObject *args)
+{
+    return sqlin_quote(self->wrapped,
+        (connectionObject *)self->connection, self->array);
+}
+
+static PyObject *
+sqlin_str(sqlinObject *self)
+{
+    return psycopg_ensure_text(sqlin_getquoted(self, NULL));
+}
+
+static PyObject *
+sqlin_prepare(sqlinObject *self, PyObject *args)
+{
+    PyObject *conn;
+
+    if (!PyArg_ParseTuple(args, "O!", &connectionType, &conn))
+        return NULL;
+
+    Py_CLEAR(self->connection);
+    Py_INCREF(conn);
+    self->connection = conn;
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sqlin_conform(sqlinObject *self, PyObject *args)
+{
+    PyObject *res, *proto;
+
+    if (!PyArg_ParseTuple(args, "O", &proto)) return NULL;
+
+    if (proto == (PyObject*)&isqlquoteType)
+        res = (PyObject*)self;
+    else
+        res = Py_None;
+
+    Py_INCREF(res);
+    return res;
+}
+
+/** the SQL_IN object **/
+
+/* object member list */
+
+static struct PyMemberDef sqlinObject_members[] = {
+    {"adapted", T_OBJECT, offsetof(sqlinObject, wrapped), READONLY},
+    {"array", T_INT, offsetof(sqlinObject, array), READONLY},
+    {NULL}
+};
+
+/* object method table */
+
+static PyMethodDef sqlinObject_methods[] = {
+    {"getquoted", (PyCFunction)sqlin_getquoted, METH_NOARGS,
+     "getquoted() -> wrapped object value as SQL list or array"},
+    {"prepare", (PyCFunction)sqlin_prepare, METH_VARARGS,
+     "prepare(conn) -> prepare the items for the connection"},
+    {"__conform__", (PyCFunction)sqlin_conform, METH_VARARGS, NULL},
+    {NULL}  /* Sentinel */
+};
+
+/* initialization and finalization methods */
+
+static int
+sqlin_traverse(sqlinObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->wrapped);
+    Py_VISIT(self->connection);
+    return 0;
+}
+
+static int
+sqlin_clear(sqlinObject *self)
+{
+    Py_CLEAR(self->wrapped);
+    Py_CLEAR(self->connection);
+    return 0;
+}
+
+static void
+sqlin_dealloc(sqlinObject* self)
+{
+    PyObject_GC_UnTrack((PyObject *)self);
+    sqlin_clear(self);
+
+    Dprintf("sqlin_dealloc: deleted SQL_IN object at %p, "
+            "refcnt = " FORMAT_CODE_PY_SSIZE_T, self, Py_REFCNT(self));
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int
+sqlin_init(PyObject *obj, PyObject *args, PyObject *kwds)
+{
+    sqlinObject *self = (sqlinObject *)obj;
+    PyObject *seq, *array = Py_False;
+    int rv;
+
+    static char *kwlist[] = {"seq", "array", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist,
+            &seq, &array)) {
+        return -1;
+    }
+    if (0 > (rv = PyObject_IsTrue(array))) {
+        return -1;
+    }
+
+    Py_CLEAR(self->wrapped);
+    Py_INCREF(seq);
+    self->wrapped = seq;
+    self->array = rv;
+    return 0;
+}
+
+static PyObject *
+sqlin_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    return type->tp_alloc(type, 0);
+}
+
+
+/* object type */
+
+#define sqlinType_doc \
+"SQL_IN(seq, array=False) -> new wrapper object for an IN list\n\n" \
+"Adapt any iterable to a list of values, such as ``(1, 2, 3)``, to use\n" \
+"with the ``IN`` operator. If *array* is true adapt it to an array, to use\n" \
+"with ``= ANY()``: sequences of numbers or strings become a literal such as\n" \
+"``'{1,2,3}'::int8[]``, the same for every length of the sequence."
+
+PyTypeObject sqlinType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "psycopg2.extensions.SQL_IN",
+    sizeof(sqlinObject), 0,
+    (destructor)sqlin_dealloc, /*tp_dealloc*/
+    0,          /*tp_print*/
+    0,          /*tp_getattr*/
+    0,          /*tp_setattr*/
+    0,          /*tp_compare*/
+    0,          /*tp_repr*/
+    0,          /*tp_as_number*/
+    0,          /*tp_as_sequence*/
+    0,          /*tp_as_mapping*/
+    0,          /*tp_hash */
+    0,          /*tp_call*/
+    (reprfunc)sqlin_str, /*tp_str*/
+    0,          /*tp_getattro*/
+    0,          /*tp_setattro*/
+    0,          /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE|Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    sqlinType_doc, /*tp_doc*/
+    (traverseproc)sqlin_traverse, /*tp_traverse*/
+    (inquiry)sqlin_clear, /*tp_clear*/
+    0,          /*tp_richcompare*/
+    0,          /*tp_weaklistoffset*/
+    0,          /*tp_iter*/
+    0,          /*tp_iternext*/
+    sqlinObject_methods, /*tp_methods*/
+    sqlinObject_members, /*tp_members*/
+    0,          /*tp_getset*/
+    0,          /*tp_base*/
+    0,          /*tp_dict*/
+    0,          /*tp_descr_get*/
+    0,          /*tp_descr_set*/
+    0,          /*tp_dictoffset*/
+    sqlin_init, /*tp_init*/
+    0,          /*tp_alloc*/
+    sqlin_new, /*tp_new*/
+};
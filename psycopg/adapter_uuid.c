@@ -0,0 +1,70 @@
+/* adapter_uuid.c - quote uuid.UUID objects
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/adapter_uuid.h"
+
+#include <string.h>
+
+
+/* Quote an UUID as 'xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx'::uuid from its
+ * `int` attribute, without creating its string. */
+PyObject *
+psyco_uuid_quote(PyObject *module, PyObject *args)
+{
+    static const char hex[] = "0123456789abcdef";
+    PyObject *u, *num = NULL, *tmp, *rv = NULL;
+    unsigned char bytes[16];
+    char *ptr;
+    int i;
+
+    if (!PyArg_ParseTuple(args, "O", &u)) { return NULL; }
+
+    if (!(tmp = PyObject_GetAttrString(u, "int"))) { goto exit; }
+    num = PyNumber_Long(tmp);
+    Py_DECREF(tmp);
+    if (!num) { goto exit; }
+
+    if (0 > psycopg_long_as_bytes(num, bytes, 16)) {
+        goto exit;
+    }
+
+    if (!(rv = Bytes_FromStringAndSize(NULL, 44))) { goto exit; }
+    ptr = Bytes_AS_STRING(rv);
+    *ptr++ = '\'';
+    for (i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) { *ptr++ = '-'; }
+        *ptr++ = hex[bytes[i] >> 4];
+        *ptr++ = hex[bytes[i] & 0x0f];
+    }
+    memcpy(ptr, "'::uuid", 7);
+
+exit:
+    Py_XDECREF(num);
+    return rv;
+}
@@ -202,4 +202,16 @@ static double round(double num)
 #define RAISES
 #endif
 
+/* SSE2 intrinsics, available on every x86-64 and on x86 if enabled.
+ *
+ * The loops using them (ascii check, string scan, hex coding) are bound by
+ * memory bandwidth: being part of the x86-64 baseline, SSE2 needs no CPU
+ * detection, and no AVX2 variant is dispatched at runtime. Other platforms
+ * use the word at time loops. */
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PSYCOPG_HAVE_SSE2 1
+#endif
+
 #endif /* !defined(PSYCOPG_CONFIG_H) */
@@ -68,6 +68,12 @@ extern "C" {
 /* Hard limit on the notices stored by the Python connection */
 #define CONN_NOTICES_LIMIT 50
 
+/* Number of compiled queries kept by the connection */
+#define CONN_QUERIES_LIMIT 512
+
+/* Number of quoted identifiers kept by the connection */
+#define CONN_IDENTS_LIMIT 1024
+
 /* we need the initial date style to be ISO, for typecasters; if the user
    later change it, she must know what she's doing... these are the queries we
    need to issue */
@@ -140,6 +146,16 @@ struct connectionObject {
     int isolevel;
     int readonly;
     int deferrable;
+
+    /* compiled queries: the dict maps the queries to the templates, which
+     * are also in a list to discard the least recently used */
+    PyObject *queries;
+    struct queryTemplateObject *queries_head;
+    struct queryTemplateObject *queries_tail;
+    Py_ssize_t nqueries;
+
+    /* quoted identifiers, by the identifier string; depend on the encoding */
+    PyObject *idents;
 };
 
 /* map isolation level values into a numeric const */
@@ -152,6 +168,8 @@ typedef struct {
 HIDDEN PyObject *conn_text_from_chars(connectionObject *pgconn, const char *str);
 HIDDEN PyObject *conn_encode(connectionObject *self, PyObject *b);
 HIDDEN PyObject *conn_decode(connectionObject *self, const char *str, Py_ssize_t len);
+HIDDEN int  conn_is_ascii_safe(connectionObject *self);
+HIDDEN PyObject *conn_quote_ident(connectionObject *self, PyObject *ident);
 HIDDEN int  conn_get_standard_conforming_strings(PGconn *pgconn);
 HIDDEN PyObject *conn_pgenc_to_pyenc(const char *encoding, char **clean_encoding);
 HIDDEN int  conn_get_protocol_version(PGconn *pgconn);
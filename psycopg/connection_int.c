@@ -116,6 +116,8 @@ exit:
  *
  * len can be < 0: in this case it will be calculated
  *
+ * Pure ASCII strings are decoded without going through the codec.
+ *
  * If no connection or encoding is available, default to utf8
  */
 PyObject *
@@ -127,6 +129,10 @@ conn_decode(connectionObject *self, const char *str, Py_ssize_t len)
 
     if (len < 0) { len = strlen(str); }
 
+    if (psycopg_is_ascii(str, len)) {
+        return psycopg_unicode_from_ascii(str, len);
+    }
+
     if (self) {
         if (self->cdecoder) {
             return self->cdecoder(str, len, NULL);
@@ -150,6 +156,68 @@ exit:
     return rv;
 }
 
+/* Return 1 if in the connection encoding the bytes of the multibyte chars
+ * all have the high bit set, so they can't be taken for a quote.
+ *
+ * It's false for some client-only encodings, which libpq must escape. */
+int
+conn_is_ascii_safe(connectionObject *self)
+{
+    static const char *unsafe[] = {
+        "SJIS", "SHIFTJIS2004", "BIG5", "GBK", "UHC", "GB18030", "JOHAB",
+        NULL};
+    const char **enc;
+
+    if (!self->encoding) { return 0; }
+    for (enc = unsafe; *enc; enc++) {
+        if (0 == strcmp(self->encoding, *enc)) { return 0; }
+    }
+    return 1;
+}
+
+/* Return the identifier quoted by PQescapeIdentifier as a "string".
+ *
+ * The queries are usually composed with the same few identifiers, so the
+ * results for the native strings are cached in the connection. Only one type
+ * is stored in the cache, to avoid comparing bytes and unicode keys.
+ */
+PyObject *
+conn_quote_ident(connectionObject *self, PyObject *ident)
+{
+    PyObject *b = NULL, *rv = NULL;
+    char *quoted = NULL;
+    int cache;
+
+    /* a closed connection must raise the error of the escape function */
+    cache = self->pgconn && Py_TYPE(ident) == &Text_Type;
+    if (cache && (rv = PyDict_GetItem(self->idents, ident))) {
+        Py_INCREF(rv);
+        return rv;
+    }
+
+    Py_INCREF(ident); /* for ensure_bytes */
+    if (!(b = psycopg_ensure_bytes(ident))) { goto exit; }
+
+    if (!(quoted = psycopg_escape_identifier(self,
+        Bytes_AS_STRING(b), Bytes_GET_SIZE(b)))) { goto exit; }
+
+    if (!(rv = conn_text_from_chars(self, quoted))) { goto exit; }
+
+    if (cache) {
+        if (PyDict_Size(self->idents) >= CONN_IDENTS_LIMIT) {
+            PyDict_Clear(self->idents);
+        }
+        if (0 > PyDict_SetItem(self->idents, ident, rv)) {
+            Py_CLEAR(rv);
+        }
+    }
+
+exit:
+    PQfreemem(quoted);
+    Py_XDECREF(b);
+    return rv;
+}
+
 /* conn_notice_callback - process notices */
 
 static void
@@ -532,6 +600,11 @@ conn_store_encoding(connectionObject *self, const char *encoding)
 
     conn_set_fast_codec(self);
 
+    /* the identifiers were decoded with the previous encoding */
+    if (self->idents) {
+        PyDict_Clear(self->idents);
+    }
+
     rv = 0;
 
 exit:
@@ -1089,7 +1162,7 @@ conn_poll(connectionObject *self)
             }
 
             curs = (cursorObject *)py_curs;
-            CLEARPGRES(curs->pgres);
+            curs_clear_pgres(curs);
             curs->pgres = pq_get_last_result(self);
 
             /* fetch the tuples (if there are any) and build the result. We
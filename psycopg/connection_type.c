@@ -33,6 +33,7 @@
 #include "psycopg/lobject.h"
 #include "psycopg/green.h"
 #include "psycopg/xid.h"
+#include "psycopg/query_template.h"
 
 #include <string.h>
 #include <ctype.h>
@@ -55,7 +56,7 @@ extern HIDDEN const int SRV_STATE_UNCHANGED;
 ":rtype: `extensions.cursor`"
 
 static PyObject *
-psyco_conn_cursor(connectionObject *self, PyObject *args, PyObject *kwargs)
+psyco_conn_cursor(connectionObject *self, PSYCO_ARGS)
 {
     PyObject *obj = NULL;
     PyObject *rv = NULL;
@@ -63,14 +64,14 @@ psyco_conn_cursor(connectionObject *self, PyObject *args, PyObject *kwargs)
     PyObject *factory = Py_None;
     PyObject *withhold = Py_False;
     PyObject *scrollable = Py_None;
+    PyObject *cargs[2];
 
     static char *kwlist[] = {
         "name", "cursor_factory", "withhold", "scrollable", NULL};
 
     EXC_IF_CONN_CLOSED(self);
 
-    if (!PyArg_ParseTupleAndKeywords(
-            args, kwargs, "|OOOO", kwlist,
+    if (0 > psyco_parse_args(PSYCO_ARGS_PASS, "cursor", kwlist, 0,
             &name, &factory, &withhold, &scrollable)) {
         goto exit;
     }
@@ -102,7 +103,9 @@ psyco_conn_cursor(connectionObject *self, PyObject *args, PyObject *kwargs)
     Dprintf("psyco_conn_cursor: new %s cursor for connection at %p",
         (name == Py_None ? "unnamed" : "named"), self);
 
-    if (!(obj = PyObject_CallFunctionObjArgs(factory, self, name, NULL))) {
+    cargs[0] = (PyObject *)self;
+    cargs[1] = name;
+    if (!(obj = psyco_Vectorcall(factory, cargs, 2, NULL))) {
         goto exit;
     }
 
@@ -1158,7 +1161,7 @@ psyco_conn_cancel(connectionObject *self)
 
 static struct PyMethodDef connectionObject_methods[] = {
     {"cursor", (PyCFunction)psyco_conn_cursor,
-     METH_VARARGS|METH_KEYWORDS, psyco_conn_cursor_doc},
+     PSYCO_METH_KEYWORDS, psyco_conn_cursor_doc},
     {"close", (PyCFunction)psyco_conn_close,
      METH_NOARGS, psyco_conn_close_doc},
     {"commit", (PyCFunction)psyco_conn_commit,
@@ -1351,6 +1354,8 @@ connection_setup(connectionObject *self, const char *dsn, long int async)
     self->async_status = ASYNC_DONE;
     if (!(self->string_types = PyDict_New())) { goto exit; }
     if (!(self->binary_types = PyDict_New())) { goto exit; }
+    if (!(self->queries = PyDict_New())) { goto exit; }
+    if (!(self->idents = PyDict_New())) { goto exit; }
     self->isolevel = ISOLATION_LEVEL_DEFAULT;
     self->readonly = STATE_DEFAULT;
     self->deferrable = STATE_DEFAULT;
@@ -1394,6 +1399,8 @@ connection_clear(connectionObject *self)
     Py_CLEAR(self->cursor_factory);
     Py_CLEAR(self->pyencoder);
     Py_CLEAR(self->pydecoder);
+    Py_CLEAR(self->idents);
+    conn_clear_query_templates(self);
     return 0;
 }
 
@@ -34,6 +34,23 @@ extern "C" {
 
 extern HIDDEN PyTypeObject cursorType;
 
+/* per-column caches of typecast values, defined in cursor_int.c */
+typedef struct cursValueCache cursValueCache;
+
+/* json object keys met in the current result, defined in typecast_json.c */
+typedef struct cursJsonKeys cursJsonKeys;
+
+/* tzinfo objects created by the cursor tzinfo_factory in the current result,
+ * by UTC offset in minutes */
+#define TZCACHE_SIZE 8
+
+typedef struct {
+    PyObject *factory;             /* the factory that created the objects */
+    int next;                      /* the next slot to replace */
+    int offsets[TZCACHE_SIZE];
+    PyObject *tzinfos[TZCACHE_SIZE];
+} cursTzCache;
+
 /* the typedef is forward-declared in psycopg.h */
 struct cursorObject {
     PyObject_HEAD
@@ -61,12 +78,17 @@ struct cursorObject {
 
     /* postgres connection stuff */
     PGresult   *pgres;     /* result of last query */
+    PyObject   *pgres_owner; /* pgresult owning pgres, if views on its
+                                memory were returned */
     PyObject   *pgstatus;  /* last message from the server after an execute */
     Oid         lastoid;   /* last oid from an insert or InvalidOid */
 
     PyObject *casts;       /* an array (tuple) of typecast functions */
     PyObject *caster;      /* the current typecaster object */
 
+    int intern_values;        /* 1 if repeated values share the same object */
+    cursValueCache *vcache;   /* cache of the values in the current result */
+
     PyObject  *copyfile;   /* file-like used during COPY TO/FROM ops */
     Py_ssize_t copysize;   /* size of the copy buffer during COPY TO/FROM ops */
 #define DEFAULT_COPYSIZE 16384
@@ -74,6 +96,8 @@ struct cursorObject {
 
     PyObject *tuple_factory;    /* factory for result tuples */
     PyObject *tzinfo_factory;   /* factory for tzinfo objects */
+    cursTzCache tzcache;        /* tzinfo objects created in this result */
+    cursJsonKeys *jkeys;        /* json keys parsed in this result */
 
     PyObject *query;      /* last query executed */
 
@@ -93,6 +117,13 @@ struct cursorObject {
 /* C-callable functions in cursor_int.c and cursor_type.c */
 BORROWED HIDDEN PyObject *curs_get_cast(cursorObject *self, PyObject *oid);
 HIDDEN void curs_reset(cursorObject *self);
+HIDDEN void curs_clear_pgres(cursorObject *self);
+HIDDEN int curs_value_in_result(cursorObject *self, const char *str);
+BORROWED HIDDEN PyObject *curs_get_pgres_owner(cursorObject *self);
+HIDDEN PyObject *curs_cast_interned(cursorObject *self, int col,
+                                    const char *str, Py_ssize_t len);
+HIDDEN void curs_vcache_clear(cursorObject *self);
+HIDDEN void curs_tzcache_clear(cursorObject *self);
 HIDDEN int psyco_curs_withhold_set(cursorObject *self, PyObject *pyvalue);
 HIDDEN int psyco_curs_scrollable_set(cursorObject *self, PyObject *pyvalue);
 HIDDEN PyObject *psyco_curs_validate_sql_basic(cursorObject *self, PyObject *sql);
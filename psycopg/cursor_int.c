@@ -29,6 +29,7 @@
 #include "psycopg/cursor.h"
 #include "psycopg/pqpath.h"
 #include "psycopg/typecast.h"
+#include "psycopg/typecast_binary.h"
 
 /* curs_get_cast - return the type caster for an oid.
  *
@@ -79,6 +80,275 @@ curs_reset(cursorObject *self)
 
     Py_CLEAR(self->description);
     Py_CLEAR(self->casts);
+    curs_vcache_clear(self);
+    curs_tzcache_clear(self);
+    typecast_json_keys_clear(self);
+}
+
+
+/* curs_clear_pgres - release the result of the last query
+ *
+ * If views on the result memory were returned, the result is freed when the
+ * last of them is released. Must be called with the GIL held.
+ */
+
+void
+curs_clear_pgres(cursorObject *self)
+{
+    if (self->pgres_owner) {
+        self->pgres = NULL;
+        Py_CLEAR(self->pgres_owner);
+    }
+    else {
+        CLEARPGRES(self->pgres);
+    }
+}
+
+
+/* curs_value_in_result - return 1 if `str` is a value of the current row
+ *
+ * Typecasters are called while building the current row but they may be
+ * called from Python too: use it to tell whether the data they receive
+ * lives in the cursor result.
+ */
+
+int
+curs_value_in_result(cursorObject *self, const char *str)
+{
+    int i, n;
+
+    if (!self->pgres || self->row < 0
+            || self->row >= PQntuples(self->pgres)) {
+        return 0;
+    }
+
+    n = PQnfields(self->pgres);
+    for (i = 0; i < n; i++) {
+        if (str == PQgetvalue(self->pgres, (int)self->row, i)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* curs_get_pgres_owner - return the object owning the cursor result
+ *
+ * Create it on first request: from then on the result is only freed when the
+ * cursor and every object referencing the owner are done with it.
+ */
+
+BORROWED PyObject *
+curs_get_pgres_owner(cursorObject *self)
+{
+    if (!self->pgres_owner) {
+        self->pgres_owner = pgresult_new(self->pgres);
+    }
+    return self->pgres_owner;
+}
+
+
+/* curs_tzcache_clear - release the tzinfo objects cached for the result */
+
+void
+curs_tzcache_clear(cursorObject *self)
+{
+    int i;
+
+    Py_CLEAR(self->tzcache.factory);
+    for (i = 0; i < TZCACHE_SIZE; i++) {
+        Py_CLEAR(self->tzcache.tzinfos[i]);
+    }
+    self->tzcache.next = 0;
+}
+
+
+/* Values cache
+ *
+ * When the cursor's intern_values attribute is set, every column keeps a
+ * small hash table mapping the raw value returned by the server to the
+ * object built by the typecaster, so that repeated values in a result are
+ * converted only once and share the same Python object.
+ *
+ * Only short values are cached, and only when the typecaster returns an
+ * immutable object. A column whose hit rate is too low after at least
+ * VCACHE_SAMPLE lookups stops using the cache.
+ */
+
+#define VCACHE_SLOTS 256        /* must be a power of 2 */
+#define VCACHE_PROBES 8
+#define VCACHE_MAXLEN 32
+#define VCACHE_SAMPLE 1000
+
+typedef struct {
+    PyObject *val;              /* NULL if the slot is empty */
+    int len;
+    char key[VCACHE_MAXLEN];
+} vcacheSlot;
+
+typedef struct {
+    int disabled;
+    long int lookups;
+    long int hits;
+    vcacheSlot slots[VCACHE_SLOTS];
+} vcacheColumn;
+
+struct cursValueCache {
+    int ncols;
+    vcacheColumn **cols;        /* allocated on first use of each column */
+};
+
+
+static void
+_vcache_column_free(vcacheColumn *col)
+{
+    int i;
+
+    if (!col) { return; }
+    for (i = 0; i < VCACHE_SLOTS; i++) {
+        Py_CLEAR(col->slots[i].val);
+    }
+    PyMem_Free(col);
+}
+
+/* curs_vcache_clear - release the values cached for the current result */
+
+void
+curs_vcache_clear(cursorObject *self)
+{
+    int i;
+    cursValueCache *cache = self->vcache;
+
+    if (!cache) { return; }
+    self->vcache = NULL;
+
+    for (i = 0; i < cache->ncols; i++) {
+        _vcache_column_free(cache->cols[i]);
+    }
+    PyMem_Free(cache->cols);
+    PyMem_Free(cache);
+}
+
+/* Return the cache for the column `col`, creating it if needed.
+ *
+ * Return NULL if the column doesn't use the cache; set an exception and
+ * return NULL on error (check with PyErr_Occurred()).
+ */
+static vcacheColumn *
+_vcache_get_column(cursorObject *self, int col)
+{
+    cursValueCache *cache = self->vcache;
+    vcacheColumn *rv;
+
+    if (!cache) {
+        if (!(cache = PyMem_New(cursValueCache, 1))) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        cache->ncols = (int)PyTuple_GET_SIZE(self->casts);
+        if (!(cache->cols = PyMem_New(vcacheColumn *, cache->ncols))) {
+            PyMem_Free(cache);
+            PyErr_NoMemory();
+            return NULL;
+        }
+        memset(cache->cols, 0, cache->ncols * sizeof(vcacheColumn *));
+        self->vcache = cache;
+    }
+
+    if (col >= cache->ncols) { return NULL; }
+
+    if (!(rv = cache->cols[col])) {
+        if (!(rv = PyMem_New(vcacheColumn, 1))) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        memset(rv, 0, sizeof(vcacheColumn));
+        cache->cols[col] = rv;
+    }
+
+    return rv->disabled ? NULL : rv;
+}
+
+/* Disable the cache of a column, releasing the objects it holds. */
+static void
+_vcache_disable_column(vcacheColumn *col)
+{
+    int i;
+
+    col->disabled = 1;
+    for (i = 0; i < VCACHE_SLOTS; i++) {
+        Py_CLEAR(col->slots[i].val);
+    }
+}
+
+/* curs_cast_interned - typecast a value of the column `col`
+ *
+ * Return a new reference to the same object returned for a previous
+ * identical value in the column, if available; otherwise cast the value
+ * with the column typecaster. `str` must not be NULL.
+ */
+
+PyObject *
+curs_cast_interned(cursorObject *self, int col, const char *str, Py_ssize_t len)
+{
+    vcacheColumn *cache;
+    vcacheSlot *slot, *free_slot = NULL;
+    PyObject *val;
+    unsigned long h = 2166136261UL;
+    Py_ssize_t i;
+
+    if (len > VCACHE_MAXLEN || !(cache = _vcache_get_column(self, col))) {
+        if (PyErr_Occurred()) { return NULL; }
+        return typecast_cast(
+            PyTuple_GET_ITEM(self->casts, col), str, len, (PyObject *)self);
+    }
+
+    /* FNV-1a */
+    for (i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)str[i]) * 16777619UL;
+    }
+
+    cache->lookups++;
+    for (i = 0; i < VCACHE_PROBES; i++) {
+        slot = &cache->slots[(h + i) & (VCACHE_SLOTS - 1)];
+        if (!slot->val) {
+            if (!free_slot) { free_slot = slot; }
+            continue;
+        }
+        if (slot->len == len && 0 == memcmp(slot->key, str, len)) {
+            cache->hits++;
+            Py_INCREF(slot->val);
+            return slot->val;
+        }
+    }
+
+    if (!(val = typecast_cast(
+            PyTuple_GET_ITEM(self->casts, col), str, len, (PyObject *)self))) {
+        return NULL;
+    }
+
+    if (!typecast_is_immutable(val)) {
+        _vcache_disable_column(cache);
+        return val;
+    }
+
+    if (cache->lookups >= VCACHE_SAMPLE && cache->hits < cache->lookups / 4) {
+        Dprintf("curs_cast_interned: disabling cache on column %d", col);
+        _vcache_disable_column(cache);
+        return val;
+    }
+
+    /* no free slot in the probe sequence: evict the first one */
+    if (!(slot = free_slot)) {
+        slot = &cache->slots[h & (VCACHE_SLOTS - 1)];
+        Py_CLEAR(slot->val);
+    }
+    Py_INCREF(val);
+    slot->val = val;
+    slot->len = (int)len;
+    memcpy(slot->key, str, len);
+
+    return val;
 }
 
 
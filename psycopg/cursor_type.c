@@ -33,6 +33,7 @@
 #include "psycopg/typecast.h"
 #include "psycopg/microprotocols.h"
 #include "psycopg/microprotocols_proto.h"
+#include "psycopg/query_template.h"
 
 #include <string.h>
 
@@ -367,6 +368,45 @@ _psyco_curs_merge_query_args(cursorObject *self,
     return fquery;
 }
 
+/* Merge together a query string and its arguments, adapting them.
+ *
+ * Use the template compiled by the connection, unless the query is unusual
+ * enough to need the full parsing.
+ *
+ * Return a new reference to a string with the merged query,
+ * NULL and set an exception if any happened.
+ */
+static PyObject *
+_psyco_curs_merge_query(cursorObject *self, PyObject *query, PyObject *vars)
+{
+    queryTemplateObject *tmpl;
+    PyObject *cvt = NULL, *fquery = NULL;
+
+    if (!(tmpl = conn_get_query_template(self->conn, query))) {
+        return NULL;
+    }
+
+    if (tmpl->kind != TMPL_FALLBACK) {
+        fquery = query_template_merge(tmpl, vars, self);
+        goto exit;
+    }
+
+    if (0 > _mogrify(vars, query, self, &cvt)) { goto exit; }
+
+    if (cvt) {
+        fquery = _psyco_curs_merge_query_args(self, query, cvt);
+    }
+    else {
+        fquery = query;
+        Py_INCREF(fquery);
+    }
+
+exit:
+    Py_XDECREF(cvt);
+    Py_DECREF(tmpl);
+    return fquery;
+}
+
 #define psyco_curs_execute_doc \
 "execute(query, vars=None) -- Execute query with bound vars."
 
@@ -377,7 +417,7 @@ _psyco_curs_execute(cursorObject *self,
 {
     int res = -1;
     int tmp;
-    PyObject *fquery, *cvt = NULL;
+    PyObject *fquery = NULL;
     const char *scroll;
 
     operation = psyco_curs_validate_sql_basic(self, operation);
@@ -387,7 +427,7 @@ _psyco_curs_execute(cursorObject *self,
 
     if (operation == NULL) { goto exit; }
 
-    CLEARPGRES(self->pgres);
+    curs_clear_pgres(self);
     Py_CLEAR(self->query);
     Dprintf("psyco_curs_execute: starting execution of new query");
 
@@ -397,7 +437,15 @@ _psyco_curs_execute(cursorObject *self,
 
     if (vars && vars != Py_None)
     {
-        if (0 > _mogrify(vars, operation, self, &cvt)) { goto exit; }
+        if (!(fquery = _psyco_curs_merge_query(self, operation, vars))) {
+            goto exit;
+        }
+    }
+    else {
+        /* Transfer reference ownership of the str in operation to fquery,
+           clearing the local variable to prevent cleanup from DECREFing it */
+        fquery = operation;
+        operation = NULL;
     }
 
     switch (self->scrollable) {
@@ -415,40 +463,18 @@ _psyco_curs_execute(cursorObject *self,
             goto exit;
     }
 
-    if (vars && cvt) {
-        if (!(fquery = _psyco_curs_merge_query_args(self, operation, cvt))) {
-            goto exit;
-        }
-
-        if (self->qname != NULL) {
-            self->query = Bytes_FromFormat(
-                "DECLARE %s %sCURSOR %s HOLD FOR %s",
-                self->qname,
-                scroll,
-                self->withhold ? "WITH" : "WITHOUT",
-                Bytes_AS_STRING(fquery));
-            Py_DECREF(fquery);
-        }
-        else {
-            self->query = fquery;
-        }
+    if (self->qname != NULL) {
+        self->query = Bytes_FromFormat(
+            "DECLARE %s %sCURSOR %s HOLD FOR %s",
+            self->qname,
+            scroll,
+            self->withhold ? "WITH" : "WITHOUT",
+            Bytes_AS_STRING(fquery));
+        if (!self->query) { goto exit; }
     }
     else {
-        if (self->qname != NULL) {
-            self->query = Bytes_FromFormat(
-                "DECLARE %s %sCURSOR %s HOLD FOR %s",
-                self->qname,
-                scroll,
-                self->withhold ? "WITH" : "WITHOUT",
-                Bytes_AS_STRING(operation));
-        }
-        else {
-            /* Transfer reference ownership of the str in operation to
-               self->query, clearing the local variable to prevent cleanup from
-               DECREFing it */
-            self->query = operation;
-            operation = NULL;
-        }
+        self->query = fquery;
+        fquery = NULL;
     }
 
     /* At this point, the SQL statement must be str, not unicode */
@@ -464,20 +490,20 @@ exit:
        by the caller was overwritten with either NULL or a new
        reference */
     Py_XDECREF(operation);
-    Py_XDECREF(cvt);
+    Py_XDECREF(fquery);
 
     return res;
 }
 
 static PyObject *
-psyco_curs_execute(cursorObject *self, PyObject *args, PyObject *kwargs)
+psyco_curs_execute(cursorObject *self, PSYCO_ARGS)
 {
     PyObject *vars = NULL, *operation = NULL;
 
     static char *kwlist[] = {"query", "vars", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist,
-                                     &operation, &vars)) {
+    if (0 > psyco_parse_args(PSYCO_ARGS_PASS, "execute", kwlist, 1,
+                             &operation, &vars)) {
         return NULL;
     }
 
@@ -511,7 +537,7 @@ psyco_curs_execute(cursorObject *self, PyObject *args, PyObject *kwargs)
 "executemany(query, vars_list) -- Execute many queries with bound vars."
 
 static PyObject *
-psyco_curs_executemany(cursorObject *self, PyObject *args, PyObject *kwargs)
+psyco_curs_executemany(cursorObject *self, PSYCO_ARGS)
 {
     PyObject *operation = NULL, *vars = NULL;
     PyObject *v, *iter = NULL;
@@ -522,8 +548,8 @@ psyco_curs_executemany(cursorObject *self, PyObject *args, PyObject *kwargs)
     /* reset rowcount to -1 to avoid setting it when an exception is raised */
     self->rowcount = -1;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist,
-                                     &operation, &vars)) {
+    if (0 > psyco_parse_args(PSYCO_ARGS_PASS, "executemany", kwlist, 2,
+                             &operation, &vars)) {
         return NULL;
     }
 
@@ -575,7 +601,7 @@ static PyObject *
 _psyco_curs_mogrify(cursorObject *self,
                    PyObject *operation, PyObject *vars)
 {
-    PyObject *fquery = NULL, *cvt = NULL;
+    PyObject *fquery = NULL;
 
     operation = psyco_curs_validate_sql_basic(self, operation);
     if (operation == NULL) { goto cleanup; }
@@ -588,19 +614,7 @@ _psyco_curs_mogrify(cursorObject *self,
 
     if (vars && vars != Py_None)
     {
-        if (0 > _mogrify(vars, operation, self, &cvt)) {
-            goto cleanup;
-        }
-    }
-
-    if (vars && cvt) {
-        if (!(fquery = _psyco_curs_merge_query_args(self, operation, cvt))) {
-            goto cleanup;
-        }
-
-        Dprintf("psyco_curs_mogrify: cvt->refcnt = " FORMAT_CODE_PY_SSIZE_T
-            ", fquery->refcnt = " FORMAT_CODE_PY_SSIZE_T,
-            Py_REFCNT(cvt), Py_REFCNT(fquery));
+        fquery = _psyco_curs_merge_query(self, operation, vars);
     }
     else {
         fquery = operation;
@@ -609,20 +623,19 @@ _psyco_curs_mogrify(cursorObject *self,
 
 cleanup:
     Py_XDECREF(operation);
-    Py_XDECREF(cvt);
 
     return fquery;
 }
 
 static PyObject *
-psyco_curs_mogrify(cursorObject *self, PyObject *args, PyObject *kwargs)
+psyco_curs_mogrify(cursorObject *self, PSYCO_ARGS)
 {
     PyObject *vars = NULL, *operation = NULL;
 
     static char *kwlist[] = {"query", "vars", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist,
-                                     &operation, &vars)) {
+    if (0 > psyco_parse_args(PSYCO_ARGS_PASS, "mogrify", kwlist, 1,
+                             &operation, &vars)) {
         return NULL;
     }
 
@@ -642,14 +655,15 @@ static PyObject *
 psyco_curs_cast(cursorObject *self, PyObject *args)
 {
     PyObject *oid;
-    PyObject *s;
+    PyObject *cargs[2];
     PyObject *cast;
 
-    if (!PyArg_ParseTuple(args, "OO", &oid, &s))
+    if (!PyArg_ParseTuple(args, "OO", &oid, &cargs[0]))
         return NULL;
 
     cast = curs_get_cast(self, oid);
-    return PyObject_CallFunctionObjArgs(cast, s, (PyObject *)self, NULL);
+    cargs[1] = (PyObject *)self;
+    return psyco_Vectorcall(cast, cargs, 2, NULL);
 }
 
 
@@ -678,9 +692,16 @@ _psyco_curs_prefetch(cursorObject *self)
     return i;
 }
 
+/* Build the values of `row` into `res`.
+ *
+ * If `pre` is not NULL it contains the row values already parsed by
+ * typecast_preparse() according to `kinds`: the ones parsed successfully
+ * don't need to go through the typecasters.
+ */
 RAISES_NEG static int
 _psyco_curs_buildrow_fill(cursorObject *self, PyObject *res,
-                          int row, int n, int istuple)
+                          int row, int n, int istuple,
+                          const int *kinds, typecastPreparsed *pre)
 {
     int i, len, err;
     const char *str;
@@ -700,10 +721,17 @@ _psyco_curs_buildrow_fill(cursorObject *self, PyObject *res,
         Dprintf("_psyco_curs_buildrow: row %ld, element %d, len %d",
                 self->row, i, len);
 
-        if (!(val = typecast_cast(PyTuple_GET_ITEM(self->casts, i), str, len,
-                            (PyObject*)self))) {
-            goto exit;
+        if (pre && pre[i].ok) {
+            val = typecast_from_preparsed(kinds[i], &pre[i], (PyObject*)self);
+        }
+        else if (str && self->intern_values) {
+            val = curs_cast_interned(self, i, str, len);
         }
+        else {
+            val = typecast_cast(PyTuple_GET_ITEM(self->casts, i), str, len,
+                                (PyObject*)self);
+        }
+        if (!val) { goto exit; }
 
         Dprintf("_psyco_curs_buildrow: val->refcnt = "
             FORMAT_CODE_PY_SSIZE_T,
@@ -726,7 +754,8 @@ exit:
 }
 
 static PyObject *
-_psyco_curs_buildrow(cursorObject *self, int row)
+_psyco_curs_buildrow(cursorObject *self, int row,
+                     const int *kinds, typecastPreparsed *pre)
 {
     int n;
     int istuple;
@@ -740,11 +769,13 @@ _psyco_curs_buildrow(cursorObject *self, int row)
         t = PyTuple_New(n);
     }
     else {
-        t = PyObject_CallFunctionObjArgs(self->tuple_factory, self, NULL);
+        PyObject *arg = (PyObject *)self;
+        t = psyco_Vectorcall(self->tuple_factory, &arg, 1, NULL);
     }
     if (!t) { goto exit; }
 
-    if (0 <= _psyco_curs_buildrow_fill(self, t, row, n, istuple)) {
+    if (0 <= _psyco_curs_buildrow_fill(
+            self, t, row, n, istuple, kinds, pre)) {
         rv = t;
         t = NULL;
     }
@@ -755,6 +786,103 @@ exit:
 
 }
 
+/* Rows pre-parsed at time by _psyco_curs_buildrows() */
+#define PREPARSE_ROWS 256
+
+/* Minimum number of values worth releasing the GIL for */
+#define PREPARSE_MIN_VALUES 1024
+
+/* Build `size` rows from the current one into `list`.
+ *
+ * If there are enough values whose typecasters can parse them without the
+ * GIL, the rows are converted in batches: the values are first parsed with
+ * the GIL released, then the Python objects are created holding it.
+ */
+RAISES_NEG static int
+_psyco_curs_buildrows(cursorObject *self, PyObject *list, int size)
+{
+    PGresult *pgres = self->pgres;
+    PyObject *owner = NULL;
+    PyObject *row;
+    typecastPreparsed *pre = NULL, *cell;
+    int *kinds = NULL;
+    long int row0;
+    int i, j, k, n, nrows, npre = 0;
+    int rv = -1;
+
+    n = PQnfields(pgres);
+
+    /* the interned values cache would go unused on the pre-parsed values */
+    if (!self->intern_values && (long)size * n >= PREPARSE_MIN_VALUES) {
+        if (!(kinds = PyMem_New(int, n))) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        for (j = 0; j < n; j++) {
+            kinds[j] = typecast_preparse_kind(
+                PyTuple_GET_ITEM(self->casts, j));
+            if (kinds[j] != TYPECAST_PRE_NONE) { npre++; }
+        }
+    }
+
+    if ((long)size * npre >= PREPARSE_MIN_VALUES) {
+        if (!(pre = PyMem_New(typecastPreparsed, PREPARSE_ROWS * n))) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        /* keep the result alive in case another thread releases it */
+        if (!(owner = curs_get_pgres_owner(self))) { goto exit; }
+        Py_INCREF(owner);
+    }
+
+    for (i = 0; i < size; i += nrows) {
+        nrows = size - i < PREPARSE_ROWS ? size - i : PREPARSE_ROWS;
+        row0 = self->row;
+
+        if (pre) {
+            Py_BEGIN_ALLOW_THREADS;
+            for (k = 0; k < nrows; k++) {
+                for (j = 0; j < n; j++) {
+                    cell = pre + k * n + j;
+                    if (kinds[j] == TYPECAST_PRE_NONE
+                            || PQgetisnull(pgres, row0 + k, j)) {
+                        cell->ok = 0;
+                    }
+                    else {
+                        typecast_preparse(kinds[j],
+                            PQgetvalue(pgres, row0 + k, j),
+                            PQgetlength(pgres, row0 + k, j), cell);
+                    }
+                }
+            }
+            Py_END_ALLOW_THREADS;
+
+            if (self->pgres != pgres || self->row != row0) {
+                PyErr_SetString(InterfaceError,
+                    "the cursor was used by another thread during fetch");
+                goto exit;
+            }
+        }
+
+        for (k = 0; k < nrows; k++) {
+            row = _psyco_curs_buildrow(
+                self, self->row, kinds, pre ? pre + k * n : NULL);
+            self->row++;
+            if (row == NULL) { goto exit; }
+
+            PyList_SET_ITEM(list, i + k, row);
+        }
+    }
+
+    rv = 0;
+
+exit:
+    Py_XDECREF(owner);
+    PyMem_Free(pre);
+    PyMem_Free(kinds);
+    return rv;
+}
+
 static PyObject *
 psyco_curs_fetchone(cursorObject *self)
 {
@@ -783,7 +911,7 @@ psyco_curs_fetchone(cursorObject *self)
         Py_RETURN_NONE;
     }
 
-    res = _psyco_curs_buildrow(self, self->row);
+    res = _psyco_curs_buildrow(self, self->row, NULL, NULL);
     self->row++; /* move the counter to next line */
 
     /* if the query was async aggresively free pgres, to allow
@@ -791,7 +919,7 @@ psyco_curs_fetchone(cursorObject *self)
     if (self->row >= self->rowcount
         && self->conn->async_cursor
         && PyWeakref_GetObject(self->conn->async_cursor) == (PyObject*)self)
-        CLEARPGRES(self->pgres);
+        curs_clear_pgres(self);
 
     return res;
 }
@@ -830,7 +958,7 @@ psyco_curs_next_named(cursorObject *self)
         return NULL;
     }
 
-    res = _psyco_curs_buildrow(self, self->row);
+    res = _psyco_curs_buildrow(self, self->row, NULL, NULL);
     self->row++; /* move the counter to next line */
 
     /* if the query was async aggresively free pgres, to allow
@@ -838,7 +966,7 @@ psyco_curs_next_named(cursorObject *self)
     if (self->row >= self->rowcount
         && self->conn->async_cursor
         && PyWeakref_GetObject(self->conn->async_cursor) == (PyObject*)self)
-        CLEARPGRES(self->pgres);
+        curs_clear_pgres(self);
 
     return res;
 }
@@ -854,11 +982,9 @@ psyco_curs_next_named(cursorObject *self)
 "Return an empty list when no more data is available.\n"
 
 static PyObject *
-psyco_curs_fetchmany(cursorObject *self, PyObject *args, PyObject *kwords)
+psyco_curs_fetchmany(cursorObject *self, PSYCO_ARGS)
 {
-    int i;
     PyObject *list = NULL;
-    PyObject *row = NULL;
     PyObject *rv = NULL;
 
     PyObject *pysize = NULL;
@@ -867,7 +993,8 @@ psyco_curs_fetchmany(cursorObject *self, PyObject *args, PyObject *kwords)
 
     /* allow passing None instead of omitting the *size* argument,
      * or using the method from subclasses would be a problem */
-    if (!PyArg_ParseTupleAndKeywords(args, kwords, "|O", kwlist, &pysize)) {
+    if (0 > psyco_parse_args(PSYCO_ARGS_PASS, "fetchmany", kwlist, 0,
+                             &pysize)) {
         return NULL;
     }
 
@@ -908,22 +1035,14 @@ psyco_curs_fetchmany(cursorObject *self, PyObject *args, PyObject *kwords)
 
     if (!(list = PyList_New(size))) { goto exit; }
 
-    for (i = 0; i < size; i++) {
-        row = _psyco_curs_buildrow(self, self->row);
-        self->row++;
-
-        if (row == NULL) { goto exit; }
-
-        PyList_SET_ITEM(list, i, row);
-    }
-    row = NULL;
+    if (0 > _psyco_curs_buildrows(self, list, (int)size)) { goto exit; }
 
     /* if the query was async aggresively free pgres, to allow
        successive requests to reallocate it */
     if (self->row >= self->rowcount
         && self->conn->async_cursor
         && PyWeakref_GetObject(self->conn->async_cursor) == (PyObject*)self)
-        CLEARPGRES(self->pgres);
+        curs_clear_pgres(self);
 
     /* success */
     rv = list;
@@ -931,7 +1050,6 @@ psyco_curs_fetchmany(cursorObject *self, PyObject *args, PyObject *kwords)
 
 exit:
     Py_XDECREF(list);
-    Py_XDECREF(row);
 
     return rv;
 }
@@ -949,9 +1067,8 @@ exit:
 static PyObject *
 psyco_curs_fetchall(cursorObject *self)
 {
-    int i, size;
+    int size;
     PyObject *list = NULL;
-    PyObject *row = NULL;
     PyObject *rv = NULL;
 
     EXC_IF_CURS_CLOSED(self);
@@ -978,21 +1095,14 @@ psyco_curs_fetchall(cursorObject *self)
 
     if (!(list = PyList_New(size))) { goto exit; }
 
-    for (i = 0; i < size; i++) {
-        row = _psyco_curs_buildrow(self, self->row);
-        self->row++;
-        if (row == NULL) { goto exit; }
-
-        PyList_SET_ITEM(list, i, row);
-    }
-    row = NULL;
+    if (0 > _psyco_curs_buildrows(self, list, (int)size)) { goto exit; }
 
     /* if the query was async aggresively free pgres, to allow
        successive requests to reallocate it */
     if (self->row >= self->rowcount
         && self->conn->async_cursor
         && PyWeakref_GetObject(self->conn->async_cursor) == (PyObject*)self)
-        CLEARPGRES(self->pgres);
+        curs_clear_pgres(self);
 
     /* success */
     rv = list;
@@ -1000,7 +1110,6 @@ psyco_curs_fetchall(cursorObject *self)
 
 exit:
     Py_XDECREF(list);
-    Py_XDECREF(row);
 
     return rv;
 }
@@ -1756,6 +1865,42 @@ psyco_curs_scrollable_set(cursorObject *self, PyObject *pyvalue)
     return 0;
 }
 
+/* extension: intern_values - share the objects of repeated values */
+
+#define psyco_curs_intern_values_doc \
+"Set or return whether repeated values in a column share the same object"
+
+static PyObject *
+psyco_curs_intern_values_get(cursorObject *self)
+{
+    PyObject *ret;
+    ret = self->intern_values ? Py_True : Py_False;
+    Py_INCREF(ret);
+    return ret;
+}
+
+static int
+psyco_curs_intern_values_set(cursorObject *self, PyObject *pyvalue)
+{
+    int value;
+
+    if (!pyvalue) {
+        PyErr_SetString(PyExc_AttributeError,
+            "can't delete the intern_values attribute");
+        return -1;
+    }
+
+    if ((value = PyObject_IsTrue(pyvalue)) == -1)
+        return -1;
+
+    self->intern_values = value;
+    if (!value) {
+        curs_vcache_clear(self);
+    }
+
+    return 0;
+}
+
 
 /** the cursor object **/
 
@@ -1798,13 +1943,13 @@ static struct PyMethodDef cursorObject_methods[] = {
     {"close", (PyCFunction)psyco_curs_close,
      METH_NOARGS, psyco_curs_close_doc},
     {"execute", (PyCFunction)psyco_curs_execute,
-     METH_VARARGS|METH_KEYWORDS, psyco_curs_execute_doc},
+     PSYCO_METH_KEYWORDS, psyco_curs_execute_doc},
     {"executemany", (PyCFunction)psyco_curs_executemany,
-     METH_VARARGS|METH_KEYWORDS, psyco_curs_executemany_doc},
+     PSYCO_METH_KEYWORDS, psyco_curs_executemany_doc},
     {"fetchone", (PyCFunction)psyco_curs_fetchone,
      METH_NOARGS, psyco_curs_fetchone_doc},
     {"fetchmany", (PyCFunction)psyco_curs_fetchmany,
-     METH_VARARGS|METH_KEYWORDS, psyco_curs_fetchmany_doc},
+     PSYCO_METH_KEYWORDS, psyco_curs_fetchmany_doc},
     {"fetchall", (PyCFunction)psyco_curs_fetchall,
      METH_NOARGS, psyco_curs_fetchall_doc},
     {"callproc", (PyCFunction)psyco_curs_callproc,
@@ -1826,7 +1971,7 @@ static struct PyMethodDef cursorObject_methods[] = {
     {"cast", (PyCFunction)psyco_curs_cast,
      METH_VARARGS, psyco_curs_cast_doc},
     {"mogrify", (PyCFunction)psyco_curs_mogrify,
-     METH_VARARGS|METH_KEYWORDS, psyco_curs_mogrify_doc},
+     PSYCO_METH_KEYWORDS, psyco_curs_mogrify_doc},
     {"copy_from", (PyCFunction)psyco_curs_copy_from,
      METH_VARARGS|METH_KEYWORDS, psyco_curs_copy_from_doc},
     {"copy_to", (PyCFunction)psyco_curs_copy_to,
@@ -1883,6 +2028,10 @@ static struct PyGetSetDef cursorObject_getsets[] = {
       (getter)psyco_curs_scrollable_get,
       (setter)psyco_curs_scrollable_set,
       psyco_curs_scrollable_doc, NULL },
+    { "intern_values",
+      (getter)psyco_curs_intern_values_get,
+      (setter)psyco_curs_intern_values_set,
+      psyco_curs_intern_values_doc, NULL },
     {NULL}
 };
 
@@ -1951,9 +2100,12 @@ cursor_clear(cursorObject *self)
     Py_CLEAR(self->pgstatus);
     Py_CLEAR(self->casts);
     Py_CLEAR(self->caster);
+    curs_vcache_clear(self);
     Py_CLEAR(self->copyfile);
     Py_CLEAR(self->tuple_factory);
     Py_CLEAR(self->tzinfo_factory);
+    curs_tzcache_clear(self);
+    typecast_json_keys_clear(self);
     Py_CLEAR(self->query);
     Py_CLEAR(self->string_types);
     Py_CLEAR(self->binary_types);
@@ -1976,7 +2128,7 @@ cursor_dealloc(PyObject* obj)
     PyMem_Free(self->name);
     PQfreemem(self->qname);
 
-    CLEARPGRES(self->pgres);
+    curs_clear_pgres(self);
 
     Dprintf("cursor_dealloc: deleted cursor object at %p, refcnt = "
         FORMAT_CODE_PY_SSIZE_T,
@@ -2044,6 +2196,13 @@ cursor_traverse(cursorObject *self, visitproc visit, void *arg)
     Py_VISIT(self->copyfile);
     Py_VISIT(self->tuple_factory);
     Py_VISIT(self->tzinfo_factory);
+    Py_VISIT(self->tzcache.factory);
+    {
+        int i;
+        for (i = 0; i < TZCACHE_SIZE; i++) {
+            Py_VISIT(self->tzcache.tzinfos[i]);
+        }
+    }
     Py_VISIT(self->query);
     Py_VISIT(self->string_types);
     Py_VISIT(self->binary_types);
@@ -30,24 +30,181 @@
 #include "psycopg/microprotocols_proto.h"
 #include "psycopg/cursor.h"
 #include "psycopg/connection.h"
+#include "psycopg/adapter_qstring.h"
+#include "psycopg/adapter_binary.h"
+#include "psycopg/adapter_pboolean.h"
+#include "psycopg/adapter_pint.h"
+#include "psycopg/adapter_pfloat.h"
+#include "psycopg/adapter_pdecimal.h"
+#include "psycopg/adapter_datetime.h"
+#include "psycopg/adapter_list.h"
+#include "psycopg/adapter_sqlin.h"
 
 
 /** the adapters registry **/
 
 PyObject *psyco_adapters;
 
+/* the names of the methods called on every adapted object */
+static PyObject *prepare_name = NULL;
+static PyObject *getquoted_name = NULL;
+
+/* The registry is a dict counting its changes, so that the cache of the
+ * adapters below can tell when what it knows is stale. */
+
+static unsigned long adapters_generation = 0;
+
+static int
+adapters_ass_subscript(PyObject *self, PyObject *key, PyObject *val)
+{
+    adapters_generation++;
+    return PyDict_Type.tp_as_mapping->mp_ass_subscript(self, key, val);
+}
+
+/* Call the dict method `name` on the registry, counting a change */
+static PyObject *
+adapters_call_dict(PyObject *self, const char *name,
+                   PyObject *args, PyObject *kwargs)
+{
+    PyObject *descr, *meth, *rv;
+
+    adapters_generation++;
+
+    if (!(descr = PyDict_GetItemString(PyDict_Type.tp_dict, name))) {
+        PyErr_Format(PyExc_AttributeError, "dict has no attribute '%s'", name);
+        return NULL;
+    }
+    if (!(meth = Py_TYPE(descr)->tp_descr_get(
+            descr, self, (PyObject *)Py_TYPE(self)))) {
+        return NULL;
+    }
+    rv = PyObject_Call(meth, args, kwargs);
+    Py_DECREF(meth);
+    return rv;
+}
+
+static PyObject *
+adapters_clear(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return adapters_call_dict(self, "clear", args, kwargs);
+}
+
+static PyObject *
+adapters_pop(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return adapters_call_dict(self, "pop", args, kwargs);
+}
+
+static PyObject *
+adapters_popitem(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return adapters_call_dict(self, "popitem", args, kwargs);
+}
+
+static PyObject *
+adapters_setdefault(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return adapters_call_dict(self, "setdefault", args, kwargs);
+}
+
+static PyObject *
+adapters_update(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return adapters_call_dict(self, "update", args, kwargs);
+}
+
+static PyMethodDef adaptersObject_methods[] = {
+    {"clear", (PyCFunction)adapters_clear,
+     METH_VARARGS|METH_KEYWORDS, NULL},
+    {"pop", (PyCFunction)adapters_pop,
+     METH_VARARGS|METH_KEYWORDS, NULL},
+    {"popitem", (PyCFunction)adapters_popitem,
+     METH_VARARGS|METH_KEYWORDS, NULL},
+    {"setdefault", (PyCFunction)adapters_setdefault,
+     METH_VARARGS|METH_KEYWORDS, NULL},
+    {"update", (PyCFunction)adapters_update,
+     METH_VARARGS|METH_KEYWORDS, NULL},
+    {NULL}
+};
+
+/* dict |= other, on Python versions supporting it */
+static PyObject *
+adapters_inplace_or(PyObject *self, PyObject *other)
+{
+    adapters_generation++;
+
+    if (PyDict_Type.tp_as_number && PyDict_Type.tp_as_number->nb_inplace_or) {
+        return PyDict_Type.tp_as_number->nb_inplace_or(self, other);
+    }
+    Py_INCREF(Py_NotImplemented);
+    return Py_NotImplemented;
+}
+
+/* filled in microprotocols_init(): the layout differs in Python 2 and 3 */
+static PyNumberMethods adaptersObject_as_number;
+
+static PyMappingMethods adaptersObject_as_mapping = {
+    0,                          /*mp_length*/
+    0,                          /*mp_subscript*/
+    adapters_ass_subscript      /*mp_ass_subscript*/
+};
+
+static PyTypeObject adaptersType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "psycopg2.extensions.AdaptersRegistry",
+    0,          /*tp_basicsize*/
+    0,          /*tp_itemsize*/
+    0,          /*tp_dealloc*/
+    0,          /*tp_print*/
+    0,          /*tp_getattr*/
+    0,          /*tp_setattr*/
+    0,          /*tp_compare*/
+    0,          /*tp_repr*/
+    &adaptersObject_as_number, /*tp_as_number*/
+    0,          /*tp_as_sequence*/
+    &adaptersObject_as_mapping, /*tp_as_mapping*/
+    0,          /*tp_hash */
+    0,          /*tp_call*/
+    0,          /*tp_str*/
+    0,          /*tp_getattro*/
+    0,          /*tp_setattro*/
+    0,          /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    "The adapters registry: a dict noticing its changes.", /*tp_doc*/
+    0,          /*tp_traverse*/
+    0,          /*tp_clear*/
+    0,          /*tp_richcompare*/
+    0,          /*tp_weaklistoffset*/
+    0,          /*tp_iter*/
+    0,          /*tp_iternext*/
+    adaptersObject_methods, /*tp_methods*/
+};
+
 /* microprotocols_init - initialize the adapters dictionary */
 
 int
 microprotocols_init(PyObject *dict)
 {
     /* create adapters dictionary and put it in module namespace */
-    if ((psyco_adapters = PyDict_New()) == NULL) {
+    adaptersType.tp_base = &PyDict_Type;
+    adaptersObject_as_number.nb_inplace_or = adapters_inplace_or;
+    if (0 > PyType_Ready(&adaptersType)) {
+        return -1;
+    }
+    if (!(psyco_adapters = PyObject_CallObject(
+            (PyObject *)&adaptersType, NULL))) {
         return -1;
     }
 
     PyDict_SetItemString(dict, "adapters", psyco_adapters);
 
+    if (!(prepare_name = Text_InternFromString("prepare"))) {
+        return -1;
+    }
+    if (!(getquoted_name = Text_InternFromString("getquoted"))) {
+        return -1;
+    }
+
     return 0;
 }
 
@@ -68,6 +225,7 @@ microprotocols_add(PyTypeObject *type, PyObject *proto, PyObject *cast)
 
     if (!(key = PyTuple_Pack(2, (PyObject*)type, proto))) { goto exit; }
     if (0 != PyDict_SetItem(psyco_adapters, key, cast)) { goto exit; }
+    adapters_generation++;
 
     rv = 0;
 
@@ -76,19 +234,17 @@ exit:
     return rv;
 }
 
-/* Check if one of `obj` superclasses has an adapter for `proto`.
+/* Check if one of `type` superclasses has an adapter for `proto`.
  *
  * If it does, return a *borrowed reference* to the adapter, else to None.
  */
 BORROWED static PyObject *
-_get_superclass_adapter(PyObject *obj, PyObject *proto)
+_get_superclass_adapter(PyTypeObject *type, PyObject *proto)
 {
-    PyTypeObject *type;
     PyObject *mro, *st;
     PyObject *key, *adapter;
     Py_ssize_t i, ii;
 
-    type = Py_TYPE(obj);
     if (!(
 #if PY_MAJOR_VERSION < 3
         (Py_TPFLAGS_HAVE_CLASS & type->tp_flags) &&
@@ -111,17 +267,9 @@ _get_superclass_adapter(PyObject *obj, PyObject *proto)
                 "microprotocols_adapt: using '%s' adapter to adapt '%s'",
                 ((PyTypeObject *)st)->tp_name, type->tp_name);
 
-            /* register this adapter as good for the subclass too,
-             * so that the next time it will be found in the fast path */
-
-            /* Well, no, maybe this is not a good idea.
-             * It would become a leak in case of dynamic
-             * classes generated in a loop (think namedtuples). */
-
-            /* key = PyTuple_Pack(2, (PyObject*)type, proto);
-             * PyDict_SetItem(psyco_adapters, key, adapter);
-             * Py_DECREF(key);
-             */
+            /* Don't register this adapter as good for the subclass too:
+             * it would become a leak in case of dynamic classes generated
+             * in a loop (think namedtuples). The cache below is bounded. */
             return adapter;
         }
     }
@@ -129,13 +277,179 @@ _get_superclass_adapter(PyObject *obj, PyObject *proto)
 }
 
 
+/* The cache of the adapters to ISQLQuote, by type.
+ *
+ * Each entry remembers what the registry lookup found for a type: the
+ * adapter registered for it or for a superclass, or None, and whether the
+ * objects may have a __conform__ method to try first. The entries are valid
+ * until the registry or the type change.
+ */
+
+#define ADAPTERS_CACHE_SIZE 256
+
+#define CONFORM_NEVER 0         /* no __conform__ to look for */
+#define CONFORM_INSTANCE 1      /* look only into the instance dict */
+#define CONFORM_ALWAYS 2        /* look for obj.__conform__ */
+
+typedef struct {
+    PyTypeObject *type;
+    PyObject *adapter;
+    unsigned long generation;
+    unsigned int version;
+    int conform;
+} adapterCacheEntry;
+
+static adapterCacheEntry adapters_cache[ADAPTERS_CACHE_SIZE];
+
+static PyObject *conform_name = NULL;
+
+/* Return how the objects of `type` may provide a __conform__ method */
+static int
+_type_conform(PyTypeObject *type)
+{
+    if (!conform_name) {
+        if (!(conform_name = Text_FromUTF8("__conform__"))) { return -1; }
+    }
+
+    /* also assigns the type a version tag, if possible */
+    if (_PyType_Lookup(type, conform_name)) {
+        return CONFORM_ALWAYS;
+    }
+    if (type->tp_getattro != PyObject_GenericGetAttr) {
+        return CONFORM_ALWAYS;
+    }
+    return type->tp_dictoffset ? CONFORM_INSTANCE : CONFORM_NEVER;
+}
+
+/* Return a *borrowed reference* to the ISQLQuote adapter of `type`, None if
+ * it doesn't have one, NULL on error.
+ *
+ * Set `conform` to the CONFORM_* value of the objects, unless the adapter is
+ * registered for the type itself, which comes first.
+ */
+BORROWED static PyObject *
+_get_isqlquote_adapter(PyTypeObject *type, int *conform)
+{
+    adapterCacheEntry *entry;
+    PyObject *key, *adapter;
+    PyObject *oldtype, *oldadapter;
+    int cf;
+
+    entry = &adapters_cache[((size_t)type >> 4) % ADAPTERS_CACHE_SIZE];
+    if (entry->type == type
+            && entry->generation == adapters_generation
+            && PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)
+            && entry->version == type->tp_version_tag) {
+        *conform = entry->conform;
+        return entry->adapter;
+    }
+
+    if (0 > (cf = _type_conform(type))) { return NULL; }
+
+    if (!(key = PyTuple_Pack(2, (PyObject *)type, &isqlquoteType))) {
+        return NULL;
+    }
+    adapter = PyDict_GetItem(psyco_adapters, key);
+    Py_DECREF(key);
+    if (adapter) {
+        cf = CONFORM_NEVER;
+    }
+    else if (!(adapter = _get_superclass_adapter(
+            type, (PyObject *)&isqlquoteType))) {
+        return NULL;
+    }
+
+    /* without a version tag we couldn't tell if the type changes */
+    if (PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        oldtype = (PyObject *)entry->type;
+        oldadapter = entry->adapter;
+        Py_INCREF(type);
+        entry->type = type;
+        Py_INCREF(adapter);
+        entry->adapter = adapter;
+        entry->generation = adapters_generation;
+        entry->version = type->tp_version_tag;
+        entry->conform = cf;
+        Py_XDECREF(oldadapter);
+        Py_XDECREF(oldtype);
+    }
+
+    *conform = cf;
+    return adapter;
+}
+
+/* Try obj.__conform__(proto).
+ *
+ * Return a new reference to the adapted object, or to None if the object
+ * doesn't conform, NULL on error.
+ */
+static PyObject *
+_try_conform(PyObject *obj, PyObject *proto, int conform)
+{
+    PyObject *meth = NULL, *adapted, **dictptr;
+
+    if (conform == CONFORM_INSTANCE) {
+        /* as getattr() would do, without raising AttributeError */
+        if ((dictptr = _PyObject_GetDictPtr(obj)) && *dictptr
+                && (meth = PyDict_GetItem(*dictptr, conform_name))) {
+            Py_INCREF(meth);
+        }
+    }
+    else if (conform == CONFORM_ALWAYS) {
+        if (!(meth = PyObject_GetAttrString(obj, "__conform__"))) {
+            /* obj.__conform__ not found. */
+            PyErr_Clear();
+        }
+    }
+    if (!meth) {
+        Py_RETURN_NONE;
+    }
+
+    adapted = psyco_Vectorcall(meth, &proto, 1, NULL);
+    Py_DECREF(meth);
+    if (!adapted) {
+        if (PyErr_ExceptionMatches(PyExc_TypeError)) {
+            PyErr_Clear();
+            Py_RETURN_NONE;
+        }
+    }
+    return adapted;
+}
+
+static PyObject *
+_cant_adapt(PyObject *obj)
+{
+    char buffer[256];
+
+    PyOS_snprintf(buffer, 255, "can't adapt type '%s'",
+        Py_TYPE(obj)->tp_name);
+    psyco_set_error(ProgrammingError, NULL, buffer);
+    return NULL;
+}
+
+/* Call the adapter, releasing the reference the caller took on it.
+ *
+ * The adapters are borrowed from the registry or the cache: take a reference
+ * before running any Python code, which might remove them from both.
+ */
+static PyObject *
+_call_adapter(PyObject *adapter, PyObject *obj)
+{
+    PyObject *adapted;
+
+    adapted = psyco_Vectorcall(adapter, &obj, 1, NULL);
+    Py_DECREF(adapter);
+    return adapted;
+}
+
+
 /* microprotocols_adapt - adapt an object to the built-in protocol */
 
 PyObject *
 microprotocols_adapt(PyObject *obj, PyObject *proto, PyObject *alt)
 {
     PyObject *adapter, *adapted, *key, *meth;
-    char buffer[256];
+    int conform;
 
     /* we don't check for exact type conformance as specified in PEP 246
        because the ISQLQuote type is abstract and there is no way to get a
@@ -144,18 +458,40 @@ microprotocols_adapt(PyObject *obj, PyObject *proto, PyObject *alt)
     Dprintf("microprotocols_adapt: trying to adapt %s",
         Py_TYPE(obj)->tp_name);
 
+    /* the common case: ISQLQuote has no __adapt__ and can't get one, so the
+     * lookup result only depends on the type */
+    if (proto == (PyObject *)&isqlquoteType) {
+        if (!(adapter = _get_isqlquote_adapter(Py_TYPE(obj), &conform))) {
+            return NULL;
+        }
+        Py_INCREF(adapter);
+        if (conform != CONFORM_NEVER) {
+            adapted = _try_conform(obj, proto, conform);
+            if (adapted != Py_None) {
+                Py_DECREF(adapter);
+                return adapted;
+            }
+            Py_DECREF(adapted);
+        }
+        if (adapter != Py_None) {
+            return _call_adapter(adapter, obj);
+        }
+        Py_DECREF(adapter);
+        return _cant_adapt(obj);
+    }
+
     /* look for an adapter in the registry */
     if (!(key = PyTuple_Pack(2, Py_TYPE(obj), proto))) { return NULL; }
     adapter = PyDict_GetItem(psyco_adapters, key);
     Py_DECREF(key);
     if (adapter) {
-        adapted = PyObject_CallFunctionObjArgs(adapter, obj, NULL);
-        return adapted;
+        Py_INCREF(adapter);
+        return _call_adapter(adapter, obj);
     }
 
     /* try to have the protocol adapt this object*/
     if ((meth = PyObject_GetAttrString(proto, "__adapt__"))) {
-        adapted = PyObject_CallFunctionObjArgs(meth, obj, NULL);
+        adapted = psyco_Vectorcall(meth, &obj, 1, NULL);
         Py_DECREF(meth);
         if (adapted && adapted != Py_None) return adapted;
         Py_XDECREF(adapted);
@@ -173,37 +509,62 @@ microprotocols_adapt(PyObject *obj, PyObject *proto, PyObject *alt)
     }
 
     /* then try to have the object adapt itself */
-    if ((meth = PyObject_GetAttrString(obj, "__conform__"))) {
-        adapted = PyObject_CallFunctionObjArgs(meth, proto, NULL);
-        Py_DECREF(meth);
-        if (adapted && adapted != Py_None) return adapted;
-        Py_XDECREF(adapted);
-        if (PyErr_Occurred()) {
-            if (PyErr_ExceptionMatches(PyExc_TypeError)) {
-               PyErr_Clear();
-            } else {
-                return NULL;
-            }
-        }
-    }
-    else {
-        /* obj.__conform__ not found. */
-        PyErr_Clear();
+    if (!(adapted = _try_conform(obj, proto, CONFORM_ALWAYS))) {
+        return NULL;
     }
+    if (adapted != Py_None) { return adapted; }
+    Py_DECREF(adapted);
 
     /* Finally check if a superclass can be adapted and use the same adapter. */
-    if (!(adapter = _get_superclass_adapter(obj, proto))) {
+    if (!(adapter = _get_superclass_adapter(Py_TYPE(obj), proto))) {
         return NULL;
     }
     if (Py_None != adapter) {
-        adapted = PyObject_CallFunctionObjArgs(adapter, obj, NULL);
-        return adapted;
+        Py_INCREF(adapter);
+        return _call_adapter(adapter, obj);
     }
 
     /* else set the right exception and return NULL */
-    PyOS_snprintf(buffer, 255, "can't adapt type '%s'",
-        Py_TYPE(obj)->tp_name);
-    psyco_set_error(ProgrammingError, NULL, buffer);
+    return _cant_adapt(obj);
+}
+
+/* Quote `obj` if `adapter` is the default adapter of a builtin type, without
+ * creating the adapter.
+ *
+ * Return NULL without an exception set if the adapter is not one of them.
+ */
+static PyObject *
+_quote_builtin(PyObject *obj, PyObject *adapter, connectionObject *conn)
+{
+    int dtype;
+
+    if (adapter == (PyObject *)&qstringType) {
+        return qstring_quote(obj, conn, NULL);
+    }
+    if (adapter == (PyObject *)&pintType) {
+        return pint_quote(obj);
+    }
+    if (adapter == (PyObject *)&pfloatType) {
+        return pfloat_quote(obj);
+    }
+    if (adapter == (PyObject *)&pbooleanType) {
+        return pboolean_quote(obj);
+    }
+    if (adapter == (PyObject *)&binaryType) {
+        return binary_quote(obj, conn);
+    }
+    if (adapter == (PyObject *)&pdecimalType) {
+        return pdecimal_quote(obj);
+    }
+    if (0 <= (dtype = pydatetime_default_type(adapter, obj))) {
+        return pydatetime_quote(obj, dtype);
+    }
+    if (adapter == (PyObject *)&listType) {
+        return list_quote(obj, conn);
+    }
+    if (adapter == (PyObject *)&sqlinType) {
+        return sqlin_quote(obj, conn, 0);
+    }
     return NULL;
 }
 
@@ -217,7 +578,22 @@ microprotocol_getquoted(PyObject *obj, connectionObject *conn)
 {
     PyObject *res = NULL;
     PyObject *prepare = NULL;
-    PyObject *adapted;
+    PyObject *adapted = NULL;
+    PyObject *adapter;
+    int conform;
+
+    if (!(adapter = _get_isqlquote_adapter(Py_TYPE(obj), &conform))) {
+        goto exit;
+    }
+    if (conform == CONFORM_NEVER) {
+        /* the builtin adapters may call back into Python */
+        Py_INCREF(adapter);
+        res = _quote_builtin(obj, adapter, conn);
+        Py_DECREF(adapter);
+        if (res || PyErr_Occurred()) {
+            goto exit;
+        }
+    }
 
     if (!(adapted = microprotocols_adapt(obj, (PyObject*)&isqlquoteType, NULL))) {
        goto exit;
@@ -228,9 +604,9 @@ microprotocol_getquoted(PyObject *obj, connectionObject *conn)
 
     /* if requested prepare the object passing it the connection */
     if (conn) {
-        if ((prepare = PyObject_GetAttrString(adapted, "prepare"))) {
-            res = PyObject_CallFunctionObjArgs(
-                prepare, (PyObject *)conn, NULL);
+        if ((prepare = PyObject_GetAttr(adapted, prepare_name))) {
+            PyObject *arg = (PyObject *)conn;
+            res = psyco_Vectorcall(prepare, &arg, 1, NULL);
             if (res) {
                 Py_DECREF(res);
                 res = NULL;
@@ -246,7 +622,7 @@ microprotocol_getquoted(PyObject *obj, connectionObject *conn)
 
     /* call the getquoted method on adapted (that should exist because we
        adapted to the right protocol) */
-    res = PyObject_CallMethod(adapted, "getquoted", NULL);
+    res = psyco_CallMethodNoArgs(adapted, getquoted_name);
 
     /* Convert to bytes. */
     if (res && PyUnicode_CheckExact(res)) {
@@ -1016,6 +1016,9 @@ pq_execute(cursorObject *curs, const char *query, int async, int no_result, int
     }
     Dprintf("pq_execute: pg connection at %p OK", curs->conn->pgconn);
 
+    /* release the previous result here: it may need the GIL to go */
+    curs_clear_pgres(curs);
+
     Py_BEGIN_ALLOW_THREADS;
     pthread_mutex_lock(&(curs->conn->lock));
 
@@ -1027,7 +1030,6 @@ pq_execute(cursorObject *curs, const char *query, int async, int no_result, int
     }
 
     if (async == 0) {
-        CLEARPGRES(curs->pgres);
         Dprintf("pq_execute: executing SYNC query: pgconn = %p", curs->conn->pgconn);
         Dprintf("    %-.200s", query);
         if (!psyco_green()) {
@@ -1069,7 +1071,6 @@ pq_execute(cursorObject *curs, const char *query, int async, int no_result, int
         Dprintf("pq_execute: executing ASYNC query: pgconn = %p", curs->conn->pgconn);
         Dprintf("    %-.200s", query);
 
-        CLEARPGRES(curs->pgres);
         if (PQsendQuery(curs->conn->pgconn, query) == 0) {
             if (CONNECTION_BAD == PQstatus(curs->conn->pgconn)) {
                 curs->conn->closed = 2;
@@ -1258,8 +1259,8 @@ _pq_fetch_tuples(cursorObject *curs)
         PyObject *type = NULL;
         PyObject *cast = NULL;
 
-        if (!(column = (columnObject *)PyObject_CallObject(
-                (PyObject *)&columnType, NULL))) {
+        if (!(column = (columnObject *)psyco_Vectorcall(
+                (PyObject *)&columnType, NULL, 0, NULL))) {
             goto exit;
         }
 
@@ -1273,7 +1274,15 @@ _pq_fetch_tuples(cursorObject *curs)
             goto err_for;
         }
         Dprintf("_pq_fetch_tuples: looking for cast %d:", ftype);
-        cast = curs_get_cast(curs, type);
+
+        /* columns in binary format use the binary typecasters if any */
+        cast = NULL;
+        if (PQfformat(curs->pgres, i) == 1) {
+            cast = PyDict_GetItem(psyco_binary_types, type);
+        }
+        if (!cast) {
+            cast = curs_get_cast(curs, type);
+        }
 
         /* else if we got binary tuples and if we got a field that
            is binary use the default cast
@@ -1522,7 +1531,7 @@ _pq_copy_in_v3(cursorObject *curs)
         res = PQputCopyEnd(curs->conn->pgconn, buf);
     }
 
-    CLEARPGRES(curs->pgres);
+    curs_clear_pgres(curs);
 
     Dprintf("_pq_copy_in_v3: copy ended; res = %d", res);
 
@@ -1547,7 +1556,7 @@ _pq_copy_in_v3(cursorObject *curs)
             _read_rowcount(curs);
             if (PQresultStatus(curs->pgres) == PGRES_FATAL_ERROR)
                 pq_raise(curs->conn, curs, NULL);
-            CLEARPGRES(curs->pgres);
+            curs_clear_pgres(curs);
         }
     }
 
@@ -1620,7 +1629,7 @@ _pq_copy_out_v3(cursorObject *curs)
     }
 
     /* and finally we grab the operation result from the backend */
-    CLEARPGRES(curs->pgres);
+    curs_clear_pgres(curs);
     for (;;) {
         Py_BEGIN_ALLOW_THREADS;
         curs->pgres = PQgetResult(curs->conn->pgconn);
@@ -1631,7 +1640,7 @@ _pq_copy_out_v3(cursorObject *curs)
         _read_rowcount(curs);
         if (PQresultStatus(curs->pgres) == PGRES_FATAL_ERROR)
             pq_raise(curs->conn, curs, NULL);
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
     }
     ret = 1;
 
@@ -1709,7 +1718,7 @@ retry:
             goto exit;
         }
 
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
         ret = 0;
         goto exit;
     }
@@ -1845,7 +1854,7 @@ pq_copy_both(replicationCursorObject *repl, PyObject *consume, double keepalive_
         goto exit;
     }
 
-    CLEARPGRES(curs->pgres);
+    curs_clear_pgres(curs);
 
     keep_intr.tv_sec  = (int)keepalive_interval;
     keep_intr.tv_usec = (long)((keepalive_interval - keep_intr.tv_sec)*1.0e6);
@@ -1956,7 +1965,7 @@ pq_fetch(cursorObject *curs, int no_result)
         Dprintf("pq_fetch: command returned OK (no tuples)");
         _read_rowcount(curs);
         curs->lastoid = PQoidValue(curs->pgres);
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
         ex = 1;
         break;
 
@@ -1966,7 +1975,7 @@ pq_fetch(cursorObject *curs, int no_result)
         ex = _pq_copy_out_v3(curs);
         /* error caught by out glorious notice handler */
         if (PyErr_Occurred()) ex = -1;
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
         break;
 
     case PGRES_COPY_IN:
@@ -1975,7 +1984,7 @@ pq_fetch(cursorObject *curs, int no_result)
         ex = _pq_copy_in_v3(curs);
         /* error caught by out glorious notice handler */
         if (PyErr_Occurred()) ex = -1;
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
         break;
 
     case PGRES_COPY_BOTH:
@@ -1986,7 +1995,7 @@ pq_fetch(cursorObject *curs, int no_result)
 
            Also don't clear the result status: it's checked in
            consume_stream. */
-        /*CLEARPGRES(curs->pgres);*/
+        /*curs_clear_pgres(curs);*/
         break;
 
     case PGRES_TUPLES_OK:
@@ -2000,7 +2009,7 @@ pq_fetch(cursorObject *curs, int no_result)
             Dprintf("pq_fetch: got tuples, discarding them");
             /* TODO: is there any case in which PQntuples == PQcmdTuples? */
             _read_rowcount(curs);
-            CLEARPGRES(curs->pgres);
+            curs_clear_pgres(curs);
             ex = 0;
         }
         break;
@@ -2008,7 +2017,7 @@ pq_fetch(cursorObject *curs, int no_result)
     case PGRES_EMPTY_QUERY:
         PyErr_SetString(ProgrammingError,
             "can't execute an empty query");
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
         ex = -1;
         break;
 
@@ -2029,7 +2038,7 @@ pq_fetch(cursorObject *curs, int no_result)
             "got server response with unsupported status %s",
             PQresStatus(curs->pgres == NULL ?
                 PQstatus(curs->conn->pgconn) : PQresultStatus(curs->pgres)));
-        CLEARPGRES(curs->pgres);
+        curs_clear_pgres(curs);
         ex = -1;
         break;
     }
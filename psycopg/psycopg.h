@@ -118,6 +118,9 @@ typedef struct {
 /* the Decimal type, used by the DECIMAL typecaster */
 HIDDEN PyObject *psyco_GetDecimalType(void);
 
+/* the uuid.UUID type, used by the UUID typecaster */
+HIDDEN PyObject *psyco_GetUUIDType(PyObject **safe);
+
 /* forward declarations */
 typedef struct cursorObject cursorObject;
 typedef struct connectionObject connectionObject;
@@ -134,6 +137,11 @@ HIDDEN int psycopg_strdup(char **to, const char *from, Py_ssize_t len);
 HIDDEN int psycopg_is_text_file(PyObject *f);
 HIDDEN PyObject *psycopg_text_from_chars_safe(
         const char *str, Py_ssize_t len, PyObject *decoder);
+HIDDEN int psycopg_is_ascii(const char *str, Py_ssize_t len);
+HIDDEN PyObject *psycopg_unicode_from_ascii(const char *str, Py_ssize_t len);
+HIDDEN PyObject *psycopg_long_from_bytes(const unsigned char *bytes, int n);
+RAISES_NEG HIDDEN int psycopg_long_as_bytes(
+        PyObject *num, unsigned char *bytes, int n);
 
 STEALS(1) HIDDEN PyObject * psycopg_ensure_bytes(PyObject *obj);
 
@@ -144,6 +152,9 @@ HIDDEN PyObject *psycopg_dict_from_conninfo_options(PQconninfoOption *options,
 
 HIDDEN PyObject *psycopg_make_dsn(PyObject *dsn, PyObject *kwargs);
 
+RAISES_NEG HIDDEN int psyco_parse_args(PSYCO_ARGS, const char *fname,
+              char **kwlist, int nrequired, ...);
+
 /* Exceptions docstrings */
 #define Error_doc \
 "Base class for error exceptions."
@@ -42,6 +42,7 @@
 #include "psycopg/error.h"
 #include "psycopg/conninfo.h"
 #include "psycopg/diagnostics.h"
+#include "psycopg/query_template.h"
 
 #include "psycopg/adapter_qstring.h"
 #include "psycopg/adapter_binary.h"
@@ -51,6 +52,12 @@
 #include "psycopg/adapter_pdecimal.h"
 #include "psycopg/adapter_asis.h"
 #include "psycopg/adapter_list.h"
+#include "psycopg/adapter_sqlin.h"
+#include "psycopg/adapter_hstore.h"
+#include "psycopg/adapter_range.h"
+#include "psycopg/adapter_uuid.h"
+#include "psycopg/adapter_inet.h"
+#include "psycopg/sql_compose.h"
 #include "psycopg/typecast_binary.h"
 
 #ifdef HAVE_MXDATETIME
@@ -168,9 +175,8 @@ exit:
 static PyObject *
 psyco_quote_ident(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    PyObject *ident = NULL, *obj = NULL, *result = NULL;
+    PyObject *ident = NULL, *obj = NULL;
     connectionObject *conn;
-    char *quoted = NULL;
 
     static char *kwlist[] = {"ident", "scope", NULL};
     if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist, &ident, &obj)) {
@@ -189,19 +195,7 @@ psyco_quote_ident(PyObject *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    Py_INCREF(ident); /* for ensure_bytes */
-    if (!(ident = psycopg_ensure_bytes(ident))) { goto exit; }
-
-    if (!(quoted = psycopg_escape_identifier(conn,
-        Bytes_AS_STRING(ident), Bytes_GET_SIZE(ident)))) { goto exit; }
-
-    result = conn_text_from_chars(conn, quoted);
-
-exit:
-    PQfreemem(quoted);
-    Py_XDECREF(ident);
-
-    return result;
+    return conn_quote_ident(conn, ident);
 }
 
 /** type registration **/
@@ -349,6 +343,9 @@ psyco_adapters_init(PyObject *mod)
     if (0 != microprotocols_add(&PyList_Type, NULL, (PyObject*)&listType)) {
         goto exit;
     }
+    if (0 != microprotocols_add(&PyTuple_Type, NULL, (PyObject*)&sqlinType)) {
+        goto exit;
+    }
 
     /* the module has already been initialized, so we can obtain the callable
        objects directly from its dictionary :) */
@@ -784,8 +781,8 @@ psyco_is_main_interp(void)
 
     /* No cached value: cache the proper value and try again. */
     interp = PyInterpreterState_Head();
-    while (interp->next)
-        interp = interp->next;
+    while (PyInterpreterState_Next(interp))
+        interp = PyInterpreterState_Next(interp);
 
     main_interp = interp;
     assert (main_interp);
@@ -838,6 +835,61 @@ psyco_GetDecimalType(void)
 }
 
 
+/* psyco_GetUUIDType
+
+   Return a new reference to the uuid.UUID type, or NULL with an exception.
+
+   Set *safe to a new reference to the value its `is_safe` attribute gets on
+   creation, or to None if the attribute is not available (before Python 3.7).
+*/
+
+PyObject *
+psyco_GetUUIDType(PyObject **safe)
+{
+    static PyObject *cachedType = NULL;
+    static PyObject *cachedSafe = NULL;
+    PyObject *uuid = NULL, *safeType = NULL;
+    PyObject *uuidType = NULL;
+
+    /* Use the cached objects if running from the main interpreter. */
+    int can_cache = psyco_is_main_interp();
+    if (can_cache && cachedType) {
+        Py_INCREF(cachedSafe);
+        *safe = cachedSafe;
+        Py_INCREF(cachedType);
+        return cachedType;
+    }
+
+    if (!(uuid = PyImport_ImportModule("uuid"))) { goto exit; }
+    if (!(uuidType = PyObject_GetAttrString(uuid, "UUID"))) { goto exit; }
+
+    if ((safeType = PyObject_GetAttrString(uuid, "SafeUUID"))) {
+        if (!(*safe = PyObject_GetAttrString(safeType, "unknown"))) {
+            Py_CLEAR(uuidType);
+            goto exit;
+        }
+    }
+    else {
+        PyErr_Clear();
+        Py_INCREF(Py_None);
+        *safe = Py_None;
+    }
+
+    /* Store the objects from future uses. */
+    if (can_cache && !cachedType) {
+        Py_INCREF(*safe);
+        cachedSafe = *safe;
+        Py_INCREF(uuidType);
+        cachedType = uuidType;
+    }
+
+exit:
+    Py_XDECREF(safeType);
+    Py_XDECREF(uuid);
+    return uuidType;
+}
+
+
 /** method table and module initialization **/
 
 static PyMethodDef psycopgMethods[] = {
@@ -849,6 +901,16 @@ static PyMethodDef psycopgMethods[] = {
      METH_VARARGS|METH_KEYWORDS, psyco_quote_ident_doc},
     {"adapt",  (PyCFunction)psyco_microprotocols_adapt,
      METH_VARARGS, psyco_microprotocols_adapt_doc},
+    {"_hstore_quote", (PyCFunction)psyco_hstore_quote,
+     METH_VARARGS, psyco_hstore_quote_doc},
+    {"_range_quote", (PyCFunction)psyco_range_quote,
+     METH_VARARGS, psyco_range_quote_doc},
+    {"_compose", (PyCFunction)psyco_sql_compose,
+     METH_VARARGS, psyco_sql_compose_doc},
+    {"_uuid_quote", (PyCFunction)psyco_uuid_quote,
+     METH_VARARGS, psyco_uuid_quote_doc},
+    {"_inet_quote", (PyCFunction)psyco_inet_quote,
+     METH_VARARGS, psyco_inet_quote_doc},
 
     {"register_type", (PyCFunction)psyco_register_type,
      METH_VARARGS, psyco_register_type_doc},
@@ -980,8 +1042,13 @@ INIT_MODULE(_psycopg)(void)
     Py_TYPE(&listType) = &PyType_Type;
     if (PyType_Ready(&listType) == -1) goto exit;
 
+    Py_TYPE(&sqlinType) = &PyType_Type;
+    if (PyType_Ready(&sqlinType) == -1) goto exit;
+
     Py_TYPE(&chunkType) = &PyType_Type;
     if (PyType_Ready(&chunkType) == -1) goto exit;
+    Py_TYPE(&pgresultType) = &PyType_Type;
+    if (PyType_Ready(&pgresultType) == -1) goto exit;
 
     Py_TYPE(&columnType) = &PyType_Type;
     if (PyType_Ready(&columnType) == -1) goto exit;
@@ -1005,6 +1072,9 @@ INIT_MODULE(_psycopg)(void)
     Py_TYPE(&lobjectType) = &PyType_Type;
     if (PyType_Ready(&lobjectType) == -1) goto exit;
 
+    Py_TYPE(&queryTemplateType) = &PyType_Type;
+    if (PyType_Ready(&queryTemplateType) == -1) goto exit;
+
     /* initialize libcrypto threading callbacks */
     psyco_libcrypto_threads_init();
 
@@ -1098,6 +1168,7 @@ INIT_MODULE(_psycopg)(void)
     PyModule_AddObject(module, "Float", (PyObject*)&pfloatType);
     PyModule_AddObject(module, "List", (PyObject*)&listType);
     PyModule_AddObject(module, "QuotedString", (PyObject*)&qstringType);
+    PyModule_AddObject(module, "SQL_IN", (PyObject*)&sqlinType);
     PyModule_AddObject(module, "lobject", (PyObject*)&lobjectType);
 
     /* encodings dictionary in module dictionary */
@@ -1117,7 +1188,7 @@ INIT_MODULE(_psycopg)(void)
     if (0 != typecast_init(dict)) { goto exit; }
 
     /* initialize microprotocols layer */
-    microprotocols_init(dict);
+    if (0 != microprotocols_init(dict)) { goto exit; }
     if (0 != psyco_adapters_init(dict)) { goto exit; }
 
     /* create a standard set of exceptions and add them to the module's dict */
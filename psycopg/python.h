@@ -65,12 +65,14 @@ typedef unsigned long Py_uhash_t;
 #define Text_Format(f,a) PyString_Format(f,a)
 #define Text_FromUTF8(s) PyString_FromString(s)
 #define Text_FromUTF8AndSize(s,n) PyString_FromStringAndSize(s,n)
+#define Text_InternFromString(s) PyString_InternFromString(s)
 #else
 #define Text_Type PyUnicode_Type
 #define Text_Check(s) PyUnicode_Check(s)
 #define Text_Format(f,a) PyUnicode_Format(f,a)
 #define Text_FromUTF8(s) PyUnicode_FromString(s)
 #define Text_FromUTF8AndSize(s,n) PyUnicode_FromStringAndSize(s,n)
+#define Text_InternFromString(s) PyUnicode_InternFromString(s)
 #endif
 
 #if PY_MAJOR_VERSION > 2
@@ -130,6 +132,42 @@ typedef unsigned long Py_uhash_t;
 
 HIDDEN PyObject *Bytes_Format(PyObject *format, PyObject *args);
 
+/* Vectorcall is available from Python 3.8 (with a leading underscore) and
+ * public from 3.9. On older versions emulate it packing the args in a tuple,
+ * so that the callers don't need to care. */
+#if PY_VERSION_HEX >= 0x03090000
+#define psyco_Vectorcall PyObject_Vectorcall
+#elif PY_VERSION_HEX >= 0x03080000
+#define psyco_Vectorcall _PyObject_Vectorcall
+#else
+#define PY_VECTORCALL_ARGUMENTS_OFFSET \
+    ((size_t)1 << (8 * sizeof(size_t) - 1))
+HIDDEN PyObject *psyco_Vectorcall(PyObject *callable, PyObject *const *args,
+    size_t nargsf, PyObject *kwnames);
+#endif
+
+/* Call a method with no argument given its (interned) name. Before 3.9 the
+ * ObjArgs call still avoids creating the bound method. */
+#if PY_VERSION_HEX >= 0x03090000
+#define psyco_CallMethodNoArgs PyObject_CallMethodNoArgs
+#else
+#define psyco_CallMethodNoArgs(obj, name) \
+    PyObject_CallMethodObjArgs(obj, name, NULL)
+#endif
+
+/* The methods receiving keywords on the hot paths are METH_FASTCALL from
+ * Python 3.7, so that no args tuple and kwargs dict are created to call them.
+ * Declare them taking PSYCO_ARGS and parse them with psyco_parse_args(). */
+#if PY_VERSION_HEX >= 0x03070000
+#define PSYCO_METH_KEYWORDS (METH_FASTCALL | METH_KEYWORDS)
+#define PSYCO_ARGS PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+#define PSYCO_ARGS_PASS args, nargs, kwnames
+#else
+#define PSYCO_METH_KEYWORDS (METH_VARARGS | METH_KEYWORDS)
+#define PSYCO_ARGS PyObject *args, PyObject *kwargs
+#define PSYCO_ARGS_PASS args, kwargs
+#endif
+
 /* Mangle the module name into the name of the module init function */
 #if PY_MAJOR_VERSION > 2
 #define INIT_MODULE(m) PyInit_ ## m
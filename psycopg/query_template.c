@@ -0,0 +1,406 @@
+/* query_template.c - compiled queries
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/query_template.h"
+#include "psycopg/connection.h"
+#include "psycopg/cursor.h"
+#include "psycopg/microprotocols.h"
+
+#include <string.h>
+
+
+/* A query is compiled the first time it is executed on a connection: the
+ * placeholders are found once and the following executions only write the
+ * quoted arguments between the literal parts.
+ *
+ * Queries whose parsing by _mogrify() and Bytes_Format() would raise an error
+ * or do something unusual are compiled as TMPL_FALLBACK: the cursor merges
+ * them the old way, so that the user gets the same results and errors.
+ */
+
+static void
+query_template_dealloc(PyObject* obj)
+{
+    queryTemplateObject *self = (queryTemplateObject *)obj;
+
+    PyMem_Free(self->literals);
+    PyMem_Free(self->placeholders);
+    Py_XDECREF(self->query);
+    Py_XDECREF(self->keys);
+
+    Py_TYPE(obj)->tp_free(obj);
+}
+
+/* Find the placeholders in the query */
+static queryTemplateObject *
+query_template_compile(PyObject *query)
+{
+    queryTemplateObject *self;
+    PyObject *names = NULL, *keys = NULL, *key = NULL, *idx;
+    const char *p, *end, *name;
+    char *lit;
+    Py_ssize_t len, i, nph = 0;
+
+    if (!(self = PyObject_New(queryTemplateObject, &queryTemplateType))) {
+        return NULL;
+    }
+    self->prev = self->next = NULL;
+    Py_INCREF(query);
+    self->query = query;
+    self->kind = TMPL_VERBATIM;
+    self->literals = NULL;
+    self->litlen = 0;
+    self->placeholders = NULL;
+    self->nplaceholders = 0;
+    self->keys = NULL;
+
+    p = Bytes_AS_STRING(query);
+    len = Bytes_GET_SIZE(query);
+    end = p + len;
+
+    if (!memchr(p, '%', len)) { goto exit; }
+
+    /* _mogrify() would stop at the first NUL */
+    if (memchr(p, '\0', len)) { goto fallback; }
+
+    /* the literals are never longer than the query */
+    for (i = 0; p + i < end; i++) {
+        if (p[i] == '%') { nph++; }
+    }
+    if (!(self->literals = PyMem_Malloc(len))
+            || !(self->placeholders = PyMem_New(tmplPlaceholder, nph))) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    self->kind = TMPL_LITERAL;
+    lit = self->literals;
+    nph = 0;
+    while (p < end) {
+        if (*p != '%') {
+            *lit++ = *p++;
+            continue;
+        }
+        if (p + 1 >= end) { goto fallback; }
+
+        switch (p[1]) {
+        case '%':
+            *lit++ = '%';
+            p += 2;
+            break;
+
+        case 's':
+            if (self->kind == TMPL_NAMED) { goto fallback; }
+            self->kind = TMPL_POSITIONAL;
+            self->placeholders[nph].litpos = lit - self->literals;
+            self->placeholders[nph].index = nph;
+            nph++;
+            p += 2;
+            break;
+
+        case '(':
+            if (self->kind == TMPL_POSITIONAL) { goto fallback; }
+            self->kind = TMPL_NAMED;
+            name = p + 2;
+            for (p = name; p < end && *p != ')' && *p != '(' && *p != '%'; p++);
+            if (end - p < 2 || p[0] != ')' || p[1] != 's') { goto fallback; }
+
+            if (!(key = Text_FromUTF8AndSize(name, p - name))) {
+                if (!PyErr_ExceptionMatches(PyExc_UnicodeDecodeError)) {
+                    goto error;
+                }
+                PyErr_Clear();
+                goto fallback;
+            }
+            if (!names) {
+                if (!(names = PyDict_New())) { goto error; }
+                if (!(keys = PyList_New(0))) { goto error; }
+            }
+
+            /* each key is looked up and quoted only once */
+            if ((idx = PyDict_GetItem(names, key))) {
+                i = PyLong_AsSsize_t(idx);
+            }
+            else {
+                i = PyList_GET_SIZE(keys);
+                if (!(idx = PyLong_FromSsize_t(i))) { goto error; }
+                if (0 > PyDict_SetItem(names, key, idx)) {
+                    Py_DECREF(idx);
+                    goto error;
+                }
+                Py_DECREF(idx);
+                if (0 > PyList_Append(keys, key)) { goto error; }
+            }
+            Py_CLEAR(key);
+
+            self->placeholders[nph].litpos = lit - self->literals;
+            self->placeholders[nph].index = i;
+            nph++;
+            p += 2;
+            break;
+
+        default:
+            goto fallback;
+        }
+    }
+
+    self->litlen = lit - self->literals;
+    self->nplaceholders = nph;
+    if (keys && !(self->keys = PyList_AsTuple(keys))) { goto error; }
+    goto exit;
+
+fallback:
+    PyMem_Free(self->literals);
+    self->literals = NULL;
+    PyMem_Free(self->placeholders);
+    self->placeholders = NULL;
+    self->kind = TMPL_FALLBACK;
+    goto exit;
+
+error:
+    Py_CLEAR(self);
+
+exit:
+    Py_XDECREF(key);
+    Py_XDECREF(keys);
+    Py_XDECREF(names);
+    return self;
+}
+
+
+/* The connection cache */
+
+static void
+conn_unlink_query_template(connectionObject *conn, queryTemplateObject *tmpl)
+{
+    if (tmpl->prev) { tmpl->prev->next = tmpl->next; }
+    else { conn->queries_head = tmpl->next; }
+    if (tmpl->next) { tmpl->next->prev = tmpl->prev; }
+    else { conn->queries_tail = tmpl->prev; }
+    tmpl->prev = tmpl->next = NULL;
+}
+
+static void
+conn_push_query_template(connectionObject *conn, queryTemplateObject *tmpl)
+{
+    tmpl->prev = NULL;
+    tmpl->next = conn->queries_head;
+    if (conn->queries_head) { conn->queries_head->prev = tmpl; }
+    else { conn->queries_tail = tmpl; }
+    conn->queries_head = tmpl;
+}
+
+/* Return a new reference to the template of a query
+ *
+ * The template is looked up in the connection cache, where it is added if
+ * missing, discarding the least recently used if the cache is full.
+ */
+queryTemplateObject *
+conn_get_query_template(connectionObject *conn, PyObject *query)
+{
+    queryTemplateObject *tmpl, *old;
+
+    /* a bytes subclass may define its own comparison: don't cache it */
+    if (!conn->queries || !Bytes_CheckExact(query)) {
+        return query_template_compile(query);
+    }
+
+    if ((tmpl = (queryTemplateObject *)PyDict_GetItem(conn->queries, query))) {
+        if (tmpl != conn->queries_head) {
+            conn_unlink_query_template(conn, tmpl);
+            conn_push_query_template(conn, tmpl);
+        }
+        Py_INCREF(tmpl);
+        return tmpl;
+    }
+
+    if (!(tmpl = query_template_compile(query))) { return NULL; }
+    if (0 > PyDict_SetItem(conn->queries, query, (PyObject *)tmpl)) {
+        Py_DECREF(tmpl);
+        return NULL;
+    }
+    conn_push_query_template(conn, tmpl);
+
+    if (++conn->nqueries > CONN_QUERIES_LIMIT) {
+        old = conn->queries_tail;
+        conn_unlink_query_template(conn, old);
+        conn->nqueries--;
+        if (0 > PyDict_DelItem(conn->queries, old->query)) {
+            Py_DECREF(tmpl);
+            return NULL;
+        }
+    }
+
+    return tmpl;
+}
+
+/* Empty the connection cache */
+void
+conn_clear_query_templates(connectionObject *conn)
+{
+    /* the templates in use may outlive the cache */
+    while (conn->queries_head) {
+        conn_unlink_query_template(conn, conn->queries_head);
+    }
+    conn->nqueries = 0;
+    Py_CLEAR(conn->queries);
+}
+
+
+/* Merge the template with the arguments, adapting them
+ *
+ * The template kind must not be TMPL_FALLBACK. Return a new reference to the
+ * query to execute, NULL on error.
+ */
+PyObject *
+query_template_merge(queryTemplateObject *self, PyObject *vars,
+                     cursorObject *curs)
+{
+    PyObject *qbuf[16], **quoted = qbuf;
+    PyObject *v, *q, *rv = NULL;
+    Py_ssize_t nargs = 0, nvars, i, pos, size;
+    tmplPlaceholder *ph;
+    char *ptr;
+
+    switch (self->kind) {
+    case TMPL_VERBATIM:
+        Py_INCREF(self->query);
+        return self->query;
+
+    case TMPL_LITERAL:
+        return Bytes_FromStringAndSize(self->literals, self->litlen);
+
+    case TMPL_POSITIONAL:
+        nargs = self->nplaceholders;
+        break;
+
+    case TMPL_NAMED:
+        nargs = PyTuple_GET_SIZE(self->keys);
+        break;
+
+    default:
+        PyErr_SetString(InternalError, "unexpected query template kind");
+        return NULL;
+    }
+
+    if (nargs > (Py_ssize_t)(sizeof(qbuf) / sizeof(qbuf[0]))) {
+        if (!(quoted = PyMem_New(PyObject *, nargs))) {
+            return PyErr_NoMemory();
+        }
+    }
+    memset(quoted, 0, nargs * sizeof(PyObject *));
+
+    for (i = 0; i < nargs; i++) {
+        /* if the value is missing let python raise its own exception */
+        if (self->kind == TMPL_POSITIONAL) {
+            v = PySequence_GetItem(vars, i);
+        }
+        else {
+            v = PyObject_GetItem(vars, PyTuple_GET_ITEM(self->keys, i));
+        }
+        if (!v) { goto exit; }
+
+        /* None is always converted to NULL, as in _mogrify() */
+        if (v == Py_None) {
+            Py_INCREF(psyco_null);
+            q = psyco_null;
+        }
+        else {
+            q = microprotocol_getquoted(v, curs->conn);
+        }
+        Py_DECREF(v);
+        if (!(quoted[i] = q)) { goto exit; }
+
+        if (!Bytes_CheckExact(q)) {
+            PyErr_Format(PyExc_ValueError,
+                "only bytes values expected, got %s", Py_TYPE(q)->tp_name);
+            goto exit;
+        }
+    }
+
+    if (self->kind == TMPL_POSITIONAL) {
+        if (0 > (nvars = PyObject_Length(vars))) { goto exit; }
+        if (nvars > nargs) {
+            PyErr_SetString(PyExc_TypeError,
+                "not all arguments converted during string formatting");
+            goto exit;
+        }
+    }
+
+    size = self->litlen;
+    for (i = 0; i < self->nplaceholders; i++) {
+        size += Bytes_GET_SIZE(quoted[self->placeholders[i].index]);
+    }
+
+    if (!(rv = Bytes_FromStringAndSize(NULL, size))) { goto exit; }
+    ptr = Bytes_AS_STRING(rv);
+    pos = 0;
+    for (i = 0; i < self->nplaceholders; i++) {
+        ph = &self->placeholders[i];
+        memcpy(ptr, self->literals + pos, ph->litpos - pos);
+        ptr += ph->litpos - pos;
+        pos = ph->litpos;
+        q = quoted[ph->index];
+        memcpy(ptr, Bytes_AS_STRING(q), Bytes_GET_SIZE(q));
+        ptr += Bytes_GET_SIZE(q);
+    }
+    memcpy(ptr, self->literals + pos, self->litlen - pos);
+
+exit:
+    for (i = 0; i < nargs; i++) {
+        Py_XDECREF(quoted[i]);
+    }
+    if (quoted != qbuf) {
+        PyMem_Free(quoted);
+    }
+    return rv;
+}
+
+
+PyTypeObject queryTemplateType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "psycopg2._psycopg.QueryTemplate",
+    sizeof(queryTemplateObject), 0,
+    query_template_dealloc, /*tp_dealloc*/
+    0,          /*tp_print*/
+    0,          /*tp_getattr*/
+    0,          /*tp_setattr*/
+    0,          /*tp_compare*/
+    0,          /*tp_repr*/
+    0,          /*tp_as_number*/
+    0,          /*tp_as_sequence*/
+    0,          /*tp_as_mapping*/
+    0,          /*tp_hash */
+    0,          /*tp_call*/
+    0,          /*tp_str*/
+    0,          /*tp_getattro*/
+    0,          /*tp_setattro*/
+    0,          /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    "A query compiled by a connection.", /*tp_doc*/
+};
@@ -0,0 +1,77 @@
+/* query_template.h - definition for the compiled queries
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+#ifndef PSYCOPG_QUERY_TEMPLATE_H
+#define PSYCOPG_QUERY_TEMPLATE_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern HIDDEN PyTypeObject queryTemplateType;
+
+/* how the placeholders of a query are merged with the arguments */
+#define TMPL_FALLBACK   0   /* unusual query: use _mogrify + Bytes_Format */
+#define TMPL_VERBATIM   1   /* no '%' in the query: use it as it is */
+#define TMPL_LITERAL    2   /* only '%%' in the query */
+#define TMPL_POSITIONAL 3   /* '%s' placeholders */
+#define TMPL_NAMED      4   /* '%(name)s' placeholders */
+
+/* a placeholder: the literal before it ends at `litpos` in the literals */
+typedef struct {
+    Py_ssize_t litpos;
+    Py_ssize_t index;       /* the argument or the key to merge */
+} tmplPlaceholder;
+
+typedef struct queryTemplateObject {
+    PyObject_HEAD
+
+    /* the connection's cache list, most recently used first */
+    struct queryTemplateObject *prev;
+    struct queryTemplateObject *next;
+
+    PyObject *query;        /* the query compiled */
+    int kind;
+
+    char *literals;         /* the query text with the placeholders removed */
+    Py_ssize_t litlen;
+
+    tmplPlaceholder *placeholders;
+    Py_ssize_t nplaceholders;
+
+    PyObject *keys;         /* tuple of the distinct names if TMPL_NAMED */
+} queryTemplateObject;
+
+HIDDEN queryTemplateObject *conn_get_query_template(
+    connectionObject *conn, PyObject *query);
+HIDDEN void conn_clear_query_templates(connectionObject *conn);
+HIDDEN PyObject *query_template_merge(
+    queryTemplateObject *self, PyObject *vars, cursorObject *curs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !defined(PSYCOPG_QUERY_TEMPLATE_H) */
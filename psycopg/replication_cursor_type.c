@@ -122,7 +122,7 @@ psyco_repl_curs_consume_stream(replicationCursorObject *self,
                         "consume_stream: not replicating, call start_replication first");
         return NULL;
     }
-    CLEARPGRES(curs->pgres);
+    curs_clear_pgres(curs);
 
     self->consuming = 1;
 
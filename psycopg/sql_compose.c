@@ -0,0 +1,286 @@
+/* sql_compose.c - render psycopg2.sql objects
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+#define PSYCOPG_MODULE
+#include "psycopg/psycopg.h"
+
+#include "psycopg/sql_compose.h"
+#include "psycopg/cursor.h"
+#include "psycopg/microprotocols.h"
+
+
+/* The classes of psycopg2.sql rendered here. Only the exact classes are
+ * handled: the subclasses may override as_string(), so they are called. */
+static PyObject *sql_Composed = NULL;
+static PyObject *sql_SQL = NULL;
+static PyObject *sql_Identifier = NULL;
+static PyObject *sql_Literal = NULL;
+static PyObject *sql_Placeholder = NULL;
+
+static PyObject *wrapped_name = NULL;
+static PyObject *as_string_name = NULL;
+static PyObject *empty_str = NULL;
+static PyObject *dot_str = NULL;
+static PyObject *pos_placeholder = NULL;
+static PyObject *named_placeholder = NULL;
+
+static PyObject *
+sql_get_class(PyObject *module, PyObject **cls, const char *name)
+{
+    if (!*cls) {
+        *cls = PyObject_GetAttrString(module, name);
+    }
+    return *cls;
+}
+
+/* Import the psycopg2.sql classes on first use.
+ *
+ * The module imports ours, so it cannot be done at import time.
+ */
+RAISES_NEG static int
+sql_compose_init(void)
+{
+    PyObject *m = NULL;
+    int rv = -1;
+
+    if (sql_Placeholder) { return 0; }
+
+    if (!wrapped_name) {
+        if (!(wrapped_name = Text_InternFromString("_wrapped"))) { goto exit; }
+    }
+    if (!as_string_name) {
+        if (!(as_string_name = Text_InternFromString("as_string"))) {
+            goto exit;
+        }
+    }
+    if (!empty_str) {
+        if (!(empty_str = Text_FromUTF8(""))) { goto exit; }
+    }
+    if (!dot_str) {
+        if (!(dot_str = Text_FromUTF8("."))) { goto exit; }
+    }
+    if (!pos_placeholder) {
+        if (!(pos_placeholder = Text_FromUTF8("%s"))) { goto exit; }
+    }
+    if (!named_placeholder) {
+        if (!(named_placeholder = Text_FromUTF8("%%(%s)s"))) { goto exit; }
+    }
+
+    if (!(m = PyImport_ImportModule("psycopg2.sql"))) { goto exit; }
+    if (!sql_get_class(m, &sql_Composed, "Composed")) { goto exit; }
+    if (!sql_get_class(m, &sql_SQL, "SQL")) { goto exit; }
+    if (!sql_get_class(m, &sql_Identifier, "Identifier")) { goto exit; }
+    if (!sql_get_class(m, &sql_Literal, "Literal")) { goto exit; }
+    /* the last one flags the initialization complete */
+    if (!sql_get_class(m, &sql_Placeholder, "Placeholder")) { goto exit; }
+
+    rv = 0;
+
+exit:
+    Py_XDECREF(m);
+    return rv;
+}
+
+/* Join a sequence of strings as ''.join() would do */
+static PyObject *
+sql_join(PyObject *sep, PyObject *seq)
+{
+#if PY_MAJOR_VERSION < 3
+    return _PyString_Join(sep, seq);
+#else
+    return PyUnicode_Join(sep, seq);
+#endif
+}
+
+/* Return the identifiers quoted and separated by dots */
+static PyObject *
+sql_render_identifier(PyObject *strings, connectionObject *conn)
+{
+    PyObject *fast = NULL, *quoted = NULL, *tmp, *rv = NULL;
+    Py_ssize_t i, n;
+
+    if (!(fast = PySequence_Fast(strings, "Identifier strings must be a sequence"))) {
+        goto exit;
+    }
+    n = PySequence_Fast_GET_SIZE(fast);
+    if (n == 1) {
+        rv = conn_quote_ident(conn, PySequence_Fast_GET_ITEM(fast, 0));
+        goto exit;
+    }
+
+    if (!(quoted = PyList_New(n))) { goto exit; }
+    for (i = 0; i < n; i++) {
+        if (!(tmp = conn_quote_ident(conn, PySequence_Fast_GET_ITEM(fast, i)))) {
+            goto exit;
+        }
+        PyList_SET_ITEM(quoted, i, tmp);
+    }
+    rv = sql_join(dot_str, quoted);
+
+exit:
+    Py_XDECREF(quoted);
+    Py_XDECREF(fast);
+    return rv;
+}
+
+/* Return the value adapted as Literal.as_string() does */
+static PyObject *
+sql_render_literal(PyObject *obj, connectionObject *conn)
+{
+    PyObject *rv;
+
+    if (!(rv = microprotocol_getquoted(obj, conn))) { return NULL; }
+
+#if PY_MAJOR_VERSION >= 3
+    if (Bytes_Check(rv)) {
+        PyObject *tmp = rv;
+        rv = conn_decode(conn, Bytes_AS_STRING(tmp), Bytes_GET_SIZE(tmp));
+        Py_DECREF(tmp);
+    }
+#endif
+
+    return rv;
+}
+
+/* Return the string of an object of the sequence */
+static PyObject *
+sql_render_item(PyObject *item, PyObject *context, connectionObject *conn)
+{
+    PyObject *type = (PyObject *)Py_TYPE(item);
+    PyObject *wrapped, *rv = NULL;
+
+    if (type == sql_SQL) {
+        return PyObject_GetAttr(item, wrapped_name);
+    }
+
+    /* without a connection the objects raise their own error */
+    if (!(type == sql_Placeholder
+            || (conn && (type == sql_Identifier || type == sql_Literal)))) {
+        return PyObject_CallMethodObjArgs(item, as_string_name, context, NULL);
+    }
+
+    if (!(wrapped = PyObject_GetAttr(item, wrapped_name))) { return NULL; }
+
+    if (type == sql_Placeholder) {
+        if (wrapped == Py_None) {
+            Py_INCREF(pos_placeholder);
+            rv = pos_placeholder;
+        }
+        else {
+            rv = Text_Format(named_placeholder, wrapped);
+        }
+    }
+    else if (type == sql_Identifier) {
+        rv = sql_render_identifier(wrapped, conn);
+    }
+    else {
+        rv = sql_render_literal(wrapped, conn);
+    }
+
+    Py_DECREF(wrapped);
+    return rv;
+}
+
+/* Append to `parts` the strings of the objects in `seq`, recursively */
+RAISES_NEG static int
+sql_render_seq(PyObject *parts, PyObject *seq, PyObject *context,
+               connectionObject *conn)
+{
+    PyObject *fast, *item, *tmp;
+    Py_ssize_t i;
+    int rv = -1;
+
+    if (!(fast = PySequence_Fast(seq, "Composed content must be a sequence"))) {
+        return -1;
+    }
+    if (Py_EnterRecursiveCall(" while composing an SQL string")) {
+        Py_DECREF(fast);
+        return -1;
+    }
+
+    /* as_string() may run any code: don't trust the size or the items */
+    for (i = 0; i < PySequence_Fast_GET_SIZE(fast); i++) {
+        item = PySequence_Fast_GET_ITEM(fast, i);
+        Py_INCREF(item);
+
+        if ((PyObject *)Py_TYPE(item) == sql_Composed) {
+            if ((tmp = PyObject_GetAttr(item, wrapped_name))) {
+                if (0 > sql_render_seq(parts, tmp, context, conn)) {
+                    Py_CLEAR(tmp);
+                }
+                else {
+                    Py_DECREF(tmp);
+                    tmp = Py_None;  /* not NULL: success */
+                }
+            }
+        }
+        else if ((tmp = sql_render_item(item, context, conn))) {
+            if (0 > PyList_Append(parts, tmp)) {
+                Py_CLEAR(tmp);
+            }
+            else {
+                Py_DECREF(tmp);
+            }
+        }
+
+        Py_DECREF(item);
+        if (!tmp) { goto exit; }
+    }
+
+    rv = 0;
+
+exit:
+    Py_LeaveRecursiveCall();
+    Py_DECREF(fast);
+    return rv;
+}
+
+PyObject *
+psyco_sql_compose(PyObject *module, PyObject *args)
+{
+    PyObject *seq, *context, *parts = NULL, *rv = NULL;
+    connectionObject *conn = NULL;
+
+    if (!PyArg_ParseTuple(args, "OO", &seq, &context)) {
+        return NULL;
+    }
+
+    if (0 > sql_compose_init()) { goto exit; }
+
+    if (PyObject_TypeCheck(context, &cursorType)) {
+        conn = ((cursorObject *)context)->conn;
+    }
+    else if (PyObject_TypeCheck(context, &connectionType)) {
+        conn = (connectionObject *)context;
+    }
+
+    if (!(parts = PyList_New(0))) { goto exit; }
+    if (0 > sql_render_seq(parts, seq, context, conn)) { goto exit; }
+    rv = sql_join(empty_str, parts);
+
+exit:
+    Py_XDECREF(parts);
+    return rv;
+}
@@ -170,6 +170,99 @@ typecast_parse_time(const char* s, const char** t, Py_ssize_t* len,
     return cz;
 }
 
+/* Fast parsers for the fixed layout emitted by the server in ISO datestyle:
+ *
+ *   YYYY-MM-DD HH:MM:SS[.ffffff][+HH[:MM[:SS]]]
+ *
+ * They return -1 without setting an exception if the string doesn't match
+ * the layout exactly (BC dates, years past 9999, other datestyles...): in
+ * this case the caller should fall back on the generic parsers above.
+ */
+
+/* Parse `n` digits from `s` into `val`; return -1 if any is not a digit */
+static int
+typecast_parse_digits(const char *s, int n, int *val)
+{
+    int acc = 0;
+    unsigned int c;
+
+    while (n-- > 0) {
+        c = (unsigned char)*s++ - '0';
+        if (c > 9) { return -1; }
+        acc = acc * 10 + (int)c;
+    }
+
+    *val = acc;
+    return 0;
+}
+
+static int
+typecast_parse_iso_date(const char *s, Py_ssize_t len,
+                        int *year, int *month, int *day)
+{
+    if (len < 10 || s[4] != '-' || s[7] != '-') { return -1; }
+    if (typecast_parse_digits(s, 4, year) < 0
+            || typecast_parse_digits(s + 5, 2, month) < 0
+            || typecast_parse_digits(s + 8, 2, day) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* `tz` is the UTC offset in seconds, `hastz` is set to 1 if it was found */
+static int
+typecast_parse_iso_time(const char *s, Py_ssize_t len,
+                        int *hh, int *mm, int *ss, int *us,
+                        int *tz, int *hastz)
+{
+    const char *end = s + len;
+    int i, tzhh = 0, tzmm = 0, tzss = 0, tzsign;
+
+    *us = *tz = *hastz = 0;
+
+    if (len < 8 || s[2] != ':' || s[5] != ':') { return -1; }
+    if (typecast_parse_digits(s, 2, hh) < 0
+            || typecast_parse_digits(s + 3, 2, mm) < 0
+            || typecast_parse_digits(s + 6, 2, ss) < 0) {
+        return -1;
+    }
+    if (*hh > 23 || *mm > 59 || *ss > 59) { return -1; }
+    s += 8;
+
+    if (s < end && *s == '.') {
+        s++;
+        for (i = 0; i < 6 && s < end && *s >= '0' && *s <= '9'; i++, s++) {
+            *us = *us * 10 + (*s - '0');
+        }
+        if (i == 0 || (s < end && *s >= '0' && *s <= '9')) { return -1; }
+        for (; i < 6; i++) { *us *= 10; }
+    }
+
+    if (s == end) { return 0; }
+
+    if (*s != '+' && *s != '-') { return -1; }
+    tzsign = (*s++ == '-') ? -1 : 1;
+    if (end - s < 2 || typecast_parse_digits(s, 2, &tzhh) < 0) { return -1; }
+    s += 2;
+    if (s < end) {
+        if (end - s < 3 || *s != ':'
+                || typecast_parse_digits(s + 1, 2, &tzmm) < 0) {
+            return -1;
+        }
+        s += 3;
+    }
+    if (s < end) {
+        if (end - s != 3 || *s != ':'
+                || typecast_parse_digits(s + 1, 2, &tzss) < 0) {
+            return -1;
+        }
+    }
+
+    *tz = tzsign * (3600 * tzhh + 60 * tzmm + tzss);
+    *hastz = 1;
+    return 0;
+}
+
 /** include casting objects **/
 #include "psycopg/typecast_basic.c"
 #include "psycopg/typecast_binary.c"
@@ -180,6 +273,12 @@ typecast_parse_time(const char* s, const char** t, Py_ssize_t* len,
 #endif
 
 #include "psycopg/typecast_array.c"
+#include "psycopg/typecast_json.c"
+#include "psycopg/typecast_hstore.c"
+#include "psycopg/typecast_composite.c"
+#include "psycopg/typecast_range.c"
+#include "psycopg/typecast_uuid.c"
+#include "psycopg/typecast_inet.c"
 
 static long int typecast_default_DEFAULT[] = {0};
 static typecastObject_initlist typecast_default = {
@@ -217,6 +316,84 @@ static typecastObject_initlist typecast_pydatetime[] = {
     {NULL, NULL, NULL}
 };
 
+static long int typecast_INTERVALBINARY_types[] = {1186, 0};
+
+/* typecasters for columns returned in binary format */
+static typecastObject_initlist typecast_binary_builtins[] = {
+    {"PYINTERVALBINARY", typecast_INTERVALBINARY_types,
+        typecast_PYINTERVALBINARY_cast},
+    {"BYTEABINARY", typecast_BINARY_types, typecast_BYTEABINARY_cast},
+    {NULL, NULL, NULL}
+};
+
+#define typecast_DEC2NUMBERARRAY_cast typecast_GENERIC_ARRAY_cast
+
+/* numeric typecasters alternative to DECIMAL, not registered by default */
+static typecastObject_initlist typecast_dec2number[] = {
+    {"DEC2NUMBER", typecast_DECIMAL_types, typecast_DEC2NUMBER_cast},
+    {"DEC2NUMBERARRAY", typecast_DECIMALARRAY_types, typecast_DEC2NUMBERARRAY_cast, "DEC2NUMBER"},
+    {NULL, NULL, NULL}
+};
+
+/* numeric arrays returning array.array, not registered by default */
+static typecastObject_initlist typecast_pyarray[] = {
+    {"INTEGERARRAY_PYARRAY", typecast_INTEGERARRAY_types, typecast_INTEGERARRAY_PYARRAY_cast, "INTEGER"},
+    {"LONGINTEGERARRAY_PYARRAY", typecast_LONGINTEGERARRAY_types, typecast_LONGINTEGERARRAY_PYARRAY_cast, "LONGINTEGER"},
+    {"FLOATARRAY_PYARRAY", typecast_FLOATARRAY_types, typecast_FLOATARRAY_PYARRAY_cast, "FLOAT"},
+    {NULL, NULL, NULL}
+};
+
+/* json parser, used by the json typecasters created in _json.py */
+static long int typecast_JSON_types[] = {114, 3802, 0};
+
+static typecastObject_initlist typecast_json[] = {
+    {"PYJSON", typecast_JSON_types, typecast_JSON_cast},
+    {NULL, NULL, NULL}
+};
+
+/* hstore parsers, used by the typecasters created by register_hstore() */
+static long int typecast_HSTORE_types[] = {0};
+
+static typecastObject_initlist typecast_hstore[] = {
+    {"PYHSTORE", typecast_HSTORE_types, typecast_HSTORE_cast},
+#if PY_MAJOR_VERSION < 3
+    {"PYUNICODEHSTORE", typecast_HSTORE_types, typecast_UNICODEHSTORE_cast},
+#endif
+    {NULL, NULL, NULL}
+};
+
+/* composite parser, used by the typecasters created by CompositeCaster */
+static long int typecast_COMPOSITE_types[] = {0};
+
+static typecastObject_initlist typecast_composite[] = {
+    {"PYCOMPOSITE", typecast_COMPOSITE_types, typecast_COMPOSITE_cast},
+    {NULL, NULL, NULL}
+};
+
+/* range parser, used by the typecasters created by RangeCaster */
+static long int typecast_RANGE_types[] = {0};
+
+static typecastObject_initlist typecast_range[] = {
+    {"PYRANGE", typecast_RANGE_types, typecast_RANGE_cast},
+    {NULL, NULL, NULL}
+};
+
+/* uuid parser, used by the typecasters created by register_uuid() */
+static long int typecast_UUID_types[] = {0};
+
+static typecastObject_initlist typecast_uuid[] = {
+    {"PYUUID", typecast_UUID_types, typecast_UUID_cast},
+    {NULL, NULL, NULL}
+};
+
+/* inet/cidr parser, used by the typecasters created by register_ipaddress() */
+static long int typecast_INET_types[] = {0};
+
+static typecastObject_initlist typecast_inet[] = {
+    {"PYINET", typecast_INET_types, typecast_INET_cast},
+    {NULL, NULL, NULL}
+};
+
 #ifdef HAVE_MXDATETIME
 #define typecast_MXDATETIMEARRAY_cast typecast_GENERIC_ARRAY_cast
 #define typecast_MXDATETIMETZARRAY_cast typecast_GENERIC_ARRAY_cast
@@ -287,6 +464,86 @@ typecast_init(PyObject *dict)
     /* create and save a default cast object (but does not register it) */
     psyco_default_cast = typecast_from_c(&typecast_default, dict);
 
+    /* register the alternative numeric typecasters with their names */
+    for (i = 0; typecast_dec2number[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_dec2number[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_dec2number[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the array.array typecasters with their names */
+    for (i = 0; typecast_pyarray[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_pyarray[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_pyarray[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the json typecaster with its name */
+    for (i = 0; typecast_json[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_json[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_json[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the hstore typecasters with their names */
+    for (i = 0; typecast_hstore[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_hstore[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_hstore[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the composite typecaster with its name */
+    for (i = 0; typecast_composite[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_composite[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_composite[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the range typecaster with its name */
+    for (i = 0; typecast_range[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_range[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_range[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the uuid typecaster with its name */
+    for (i = 0; typecast_uuid[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_uuid[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_uuid[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
+    /* register the inet/cidr typecaster with its name */
+    for (i = 0; typecast_inet[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s", typecast_inet[i].name);
+        t = (typecastObject *)typecast_from_c(&(typecast_inet[i]), dict);
+        if (t == NULL) { goto exit; }
+        PyDict_SetItem(dict, t->name, (PyObject *)t);
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
     /* register the date/time typecasters with their original names */
 #ifdef HAVE_MXDATETIME
     if (0 == psyco_typecast_mxdatetime_init()) {
@@ -311,6 +568,18 @@ typecast_init(PyObject *dict)
         t = NULL;
     }
 
+    /* register the binary typecasters in the binary_types dictionary */
+    for (i = 0; typecast_binary_builtins[i].name != NULL; i++) {
+        Dprintf("typecast_init: initializing %s",
+            typecast_binary_builtins[i].name);
+        t = (typecastObject *)typecast_from_c(
+            &(typecast_binary_builtins[i]), dict);
+        if (t == NULL) { goto exit; }
+        if (typecast_add((PyObject *)t, NULL, 1) < 0) { goto exit; }
+        Py_DECREF((PyObject *)t);
+        t = NULL;
+    }
+
     rv = 0;
 
 exit:
@@ -572,6 +841,7 @@ PyObject *
 typecast_from_python(PyObject *self, PyObject *args, PyObject *keywds)
 {
     PyObject *v, *name = NULL, *cast = NULL, *base = NULL;
+    typecastObject *obj;
 
     static char *kwlist[] = {"values", "name", "castobj", "baseobj", NULL};
 
@@ -582,6 +852,23 @@ typecast_from_python(PyObject *self, PyObject *args, PyObject *keywds)
         return NULL;
     }
 
+    /* a C typecaster can be used for other oids without calling it from
+     * Python, which would convert the data to string first. The array
+     * typecasters (the ones with a typecaster as base) can only take another
+     * typecaster as base: else call them from Python. */
+    if (cast && PyObject_TypeCheck(cast, &typecastType)
+            && ((typecastObject *)cast)->ccast) {
+        PyObject *cbase = ((typecastObject *)cast)->bcast;
+        if (!base) { base = cbase; }
+        if (!(cbase && PyObject_TypeCheck(cbase, &typecastType))
+                || PyObject_TypeCheck(base, &typecastType)) {
+            if ((obj = (typecastObject *)typecast_new(name, v, NULL, base))) {
+                obj->ccast = ((typecastObject *)cast)->ccast;
+            }
+            return (PyObject *)obj;
+        }
+    }
+
     return typecast_new(name, v, cast, base);
 }
 
@@ -681,7 +968,10 @@ typecast_cast(PyObject *obj, const char *str, Py_ssize_t len, PyObject *curs)
             s = Py_None;
         }
         if (s) {
-            res = PyObject_CallFunctionObjArgs(self->pcast, s, curs, NULL);
+            PyObject *args[2];
+            args[0] = s;
+            args[1] = curs;
+            res = psyco_Vectorcall(self->pcast, args, 2, NULL);
             Py_DECREF(s);
         }
     }
@@ -694,3 +984,182 @@ typecast_cast(PyObject *obj, const char *str, Py_ssize_t len, PyObject *curs)
 
     return res;
 }
+
+/* Return 1 if `obj` is an instance of a builtin immutable type, so that the
+ * same object can be safely returned for several cells of a result. */
+int
+typecast_is_immutable(PyObject *obj)
+{
+    PyObject *decimalType;
+    int rv;
+
+    if (PyLong_CheckExact(obj) || PyFloat_CheckExact(obj)
+#if PY_MAJOR_VERSION < 3
+            || PyInt_CheckExact(obj)
+#endif
+            || PyBool_Check(obj)
+            || PyUnicode_CheckExact(obj) || Bytes_CheckExact(obj)
+            || PyDate_CheckExact(obj) || PyDateTime_CheckExact(obj)
+            || PyTime_CheckExact(obj) || PyDelta_CheckExact(obj)) {
+        return 1;
+    }
+
+    decimalType = psyco_GetDecimalType();
+    rv = (decimalType && (PyObject *)Py_TYPE(obj) == decimalType);
+    Py_XDECREF(decimalType);
+    return rv;
+}
+
+/* Return the TYPECAST_PRE_* kind of value the typecaster `obj` can parse
+ * with the GIL released, or TYPECAST_PRE_NONE. */
+int
+typecast_preparse_kind(PyObject *obj)
+{
+    typecast_function ccast;
+
+    if (!PyObject_TypeCheck(obj, &typecastType)) {
+        return TYPECAST_PRE_NONE;
+    }
+
+    ccast = ((typecastObject *)obj)->ccast;
+    if (ccast == typecast_INTEGER_cast) {
+        return TYPECAST_PRE_INT;
+    }
+    else if (ccast == typecast_LONGINTEGER_cast) {
+        return TYPECAST_PRE_LONG;
+    }
+    else if (ccast == typecast_BOOLEAN_cast) {
+        return TYPECAST_PRE_BOOL;
+    }
+    else if (ccast == typecast_PYDATE_cast) {
+        return TYPECAST_PRE_DATE;
+    }
+    else if (ccast == typecast_PYDATETIME_cast
+            || ccast == typecast_PYDATETIMETZ_cast) {
+        return TYPECAST_PRE_DATETIME;
+    }
+    else if (ccast == typecast_PYTIME_cast) {
+        return TYPECAST_PRE_TIME;
+    }
+    return TYPECAST_PRE_NONE;
+}
+
+/* Parse a non-null value for a typecaster of the given kind into `out`.
+ *
+ * Can be called without holding the GIL: it doesn't touch Python objects.
+ * Only the common layouts are parsed: set `out->ok` to 0 for anything else,
+ * which will be converted by the typecaster itself.
+ */
+void
+typecast_preparse(int kind, const char *str, Py_ssize_t len,
+                  typecastPreparsed *out)
+{
+    out->ok = 0;
+
+    switch (kind) {
+    case TYPECAST_PRE_INT:
+        if (0 == typecast_parse_int(str, len, &out->v.i)
+#if PY_MAJOR_VERSION < 3
+                && out->v.i >= LONG_MIN && out->v.i <= LONG_MAX
+#endif
+                ) {
+            out->ok = 1;
+        }
+        break;
+
+    case TYPECAST_PRE_LONG:
+        out->ok = (0 == typecast_parse_int(str, len, &out->v.i));
+        break;
+
+    case TYPECAST_PRE_BOOL:
+        out->v.b = (str[0] == 't');
+        out->ok = 1;
+        break;
+
+    case TYPECAST_PRE_DATE:
+        out->ok = (len == 10 && 0 == typecast_parse_iso_date(str, len,
+                &out->v.dt.y, &out->v.dt.m, &out->v.dt.d)
+            && _valid_date(out->v.dt.y, out->v.dt.m, out->v.dt.d));
+        break;
+
+    case TYPECAST_PRE_DATETIME:
+        out->v.dt.hh = out->v.dt.mm = out->v.dt.ss = out->v.dt.us = 0;
+        out->v.dt.tz = out->v.dt.hastz = 0;
+        out->ok = (0 == typecast_parse_iso_date(str, len,
+                &out->v.dt.y, &out->v.dt.m, &out->v.dt.d)
+            && (len == 10 || ((str[10] == ' ' || str[10] == 'T')
+                && 0 == typecast_parse_iso_time(str + 11, len - 11,
+                    &out->v.dt.hh, &out->v.dt.mm, &out->v.dt.ss,
+                    &out->v.dt.us, &out->v.dt.tz, &out->v.dt.hastz)))
+            && _valid_date(out->v.dt.y, out->v.dt.m, out->v.dt.d)
+            && _valid_time(out->v.dt.hh, out->v.dt.mm, out->v.dt.ss,
+                out->v.dt.us));
+        break;
+
+    case TYPECAST_PRE_TIME:
+        out->ok = (0 == typecast_parse_iso_time(str, len,
+                &out->v.dt.hh, &out->v.dt.mm, &out->v.dt.ss,
+                &out->v.dt.us, &out->v.dt.tz, &out->v.dt.hastz)
+            && _valid_time(out->v.dt.hh, out->v.dt.mm, out->v.dt.ss,
+                out->v.dt.us));
+        break;
+    }
+}
+
+/* Return the Python object for a value parsed by typecast_preparse().
+ *
+ * The value must have been parsed successfully.
+ */
+PyObject *
+typecast_from_preparsed(int kind, typecastPreparsed *val, PyObject *curs)
+{
+    PyObject *tzinfo, *rv = NULL;
+
+    switch (kind) {
+    case TYPECAST_PRE_INT:
+#if PY_MAJOR_VERSION < 3
+        return PyInt_FromLong((long)val->v.i);
+#endif
+        /* fall through */
+    case TYPECAST_PRE_LONG:
+        return PyLong_FromLongLong(val->v.i);
+
+    case TYPECAST_PRE_BOOL:
+        return PyBool_FromLong(val->v.b);
+
+    case TYPECAST_PRE_DATE:
+        return PyDateTimeAPI->Date_FromDate(val->v.dt.y, val->v.dt.m,
+            val->v.dt.d, PyDateTimeAPI->DateType);
+
+    case TYPECAST_PRE_DATETIME:
+    case TYPECAST_PRE_TIME:
+        if (val->v.dt.hastz
+                && ((cursorObject *)curs)->tzinfo_factory != Py_None) {
+            if (!(tzinfo = _get_tzinfo(
+                    (cursorObject *)curs, (int)round(val->v.dt.tz / 60.0)))) {
+                return NULL;
+            }
+        }
+        else {
+            Py_INCREF(Py_None);
+            tzinfo = Py_None;
+        }
+
+        if (kind == TYPECAST_PRE_DATETIME) {
+            rv = PyDateTimeAPI->DateTime_FromDateAndTime(
+                val->v.dt.y, val->v.dt.m, val->v.dt.d,
+                val->v.dt.hh, val->v.dt.mm, val->v.dt.ss, val->v.dt.us,
+                tzinfo, PyDateTimeAPI->DateTimeType);
+        }
+        else {
+            rv = PyDateTimeAPI->Time_FromTime(
+                val->v.dt.hh, val->v.dt.mm, val->v.dt.ss, val->v.dt.us,
+                tzinfo, PyDateTimeAPI->TimeType);
+        }
+        Py_DECREF(tzinfo);
+        return rv;
+    }
+
+    PyErr_SetString(InternalError, "unexpected pre-parsed value");
+    return NULL;
+}
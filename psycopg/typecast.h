@@ -46,7 +46,8 @@ typedef struct {
 
     typecast_function  ccast;  /* the C casting function */
     PyObject          *pcast;  /* the python casting function */
-    PyObject          *bcast;  /* base cast, used by array typecasters */
+    PyObject          *bcast;  /* base cast, used by array typecasters,
+                                  or the Composite/RangeCaster creating it */
 } typecastObject;
 
 /* the initialization values are stored here */
@@ -87,4 +88,39 @@ HIDDEN PyObject *typecast_array_from_python(
 HIDDEN PyObject *typecast_cast(
     PyObject *self, const char *str, Py_ssize_t len, PyObject *curs);
 
+/* true if a typecast result can be shared among several cells */
+HIDDEN int typecast_is_immutable(PyObject *obj);
+
+/* release the json keys cached in the cursor */
+HIDDEN void typecast_json_keys_clear(cursorObject *curs);
+
+/* values parsed without the GIL, before creating the Python objects */
+
+#define TYPECAST_PRE_NONE       0   /* the typecaster can't pre-parse */
+#define TYPECAST_PRE_INT        1
+#define TYPECAST_PRE_LONG       2
+#define TYPECAST_PRE_BOOL       3
+#define TYPECAST_PRE_DATE       4
+#define TYPECAST_PRE_DATETIME   5
+#define TYPECAST_PRE_TIME       6
+
+typedef struct {
+    int ok;             /* 0 if the value must go through the typecaster */
+    union {
+        PY_LONG_LONG i;
+        int b;
+        struct {
+            int y, m, d;
+            int hh, mm, ss, us;
+            int tz, hastz;
+        } dt;
+    } v;
+} typecastPreparsed;
+
+HIDDEN int typecast_preparse_kind(PyObject *obj);
+HIDDEN void typecast_preparse(int kind, const char *str, Py_ssize_t len,
+                              typecastPreparsed *out);
+HIDDEN PyObject *typecast_from_preparsed(int kind, typecastPreparsed *val,
+                                         PyObject *curs);
+
 #endif /* !defined(PSYCOPG_TYPECAST_H) */
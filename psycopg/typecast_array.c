@@ -254,6 +254,11 @@ typecast_GENERIC_ARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
             " len = " FORMAT_CODE_PY_SSIZE_T, str, len);
 
     if (str == NULL) { Py_RETURN_NONE; }
+    if (!(base && PyObject_TypeCheck(base, &typecastType))) {
+        PyErr_SetString(InterfaceError,
+            "the array typecaster base must be a typecaster");
+        return NULL;
+    }
     if (str[0] == '[')
         typecast_array_cleanup(&str, &len);
     if (str[0] != '{') {
@@ -278,15 +283,390 @@ typecast_GENERIC_ARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
     return obj;
 }
 
-/** almost all the basic array typecasters are derived from GENERIC **/
+/** FAST - a one pass parser for the arrays of the builtin scalar types **/
+
+/* Return 1 if the unquoted token is NULL */
+static int
+typecast_array_is_null(const char *token, Py_ssize_t length)
+{
+    return (length == 4
+        && (token[0] == 'n' || token[0] == 'N')
+        && (token[1] == 'u' || token[1] == 'U')
+        && (token[2] == 'l' || token[2] == 'L')
+        && (token[3] == 'l' || token[3] == 'L'));
+}
+
+/* Parse the array `str`, starting with '{', into the list `array`.
+ *
+ * Unlike typecast_array_scan() call the element C function `cast` directly,
+ * without going through typecast_cast(). Quoted elements containing escapes
+ * are unescaped in a single buffer allocated for the whole array.
+ */
+RAISES_NEG static int
+typecast_array_scan_fast(const char *str, Py_ssize_t len, PyObject *curs,
+                         typecast_function cast, PyObject *array)
+{
+    PyObject *stack[MAX_DIMENSIONS];
+    size_t stack_index = 0;
+    const char *end = str + len;
+    const char *p = str + 1;
+    const char *token;
+    Py_ssize_t length;
+    char *buf = NULL, *b;
+    PyObject *obj;
+    int escaped, err;
+    int rv = -1;
+
+    while (1) {
+        if (p >= end) { goto malformed; }
+
+        if (*p == '{') {
+            PyObject *sub;
+
+            if (stack_index == MAX_DIMENSIONS) {
+                PyErr_SetString(DataError, "excessive array dimensions");
+                goto exit;
+            }
+            if (!(sub = PyList_New(0))) { goto exit; }
+            err = PyList_Append(array, sub);
+            Py_DECREF(sub);
+            if (err < 0) { goto exit; }
+
+            stack[stack_index++] = array;
+            array = sub;
+            p++;
+            continue;
+        }
+
+        if (*p == '}') {
+            p++;
+            if (stack_index == 0) { break; }
+            array = stack[--stack_index];
+        }
+        else {
+            if (*p == '"') {
+                token = ++p;
+                escaped = 0;
+                while (p < end && *p != '"') {
+                    if (*p == '\\') { escaped = 1; p++; }
+                    p++;
+                }
+                if (p >= end) { goto malformed; }
+                length = p - token;
+                p++;
+
+                if (escaped) {
+                    if (!buf && !(buf = PyMem_Malloc(len))) {
+                        PyErr_NoMemory();
+                        goto exit;
+                    }
+                    for (b = buf; token < p - 1; token++) {
+                        if (*token == '\\') { token++; }
+                        *b++ = *token;
+                    }
+                    token = buf;
+                    length = b - buf;
+                }
+                obj = cast(token, length, curs);
+            }
+            else {
+                token = p;
+                while (p < end && *p != ',' && *p != '}') { p++; }
+                length = p - token;
+                if (typecast_array_is_null(token, length)) {
+                    Py_INCREF(Py_None);
+                    obj = Py_None;
+                }
+                else {
+                    obj = cast(token, length, curs);
+                }
+            }
+
+            if (!obj) { goto exit; }
+            err = PyList_Append(array, obj);
+            Py_DECREF(obj);
+            if (err < 0) { goto exit; }
+        }
+
+        /* after an element or a sub-array there is a separator or the end
+         * of the containing array */
+        if (p < end && *p == ',') {
+            p++;
+        }
+        else if (p >= end || *p != '}') {
+            goto malformed;
+        }
+    }
+
+    if (p != end) { goto malformed; }
+    rv = 0;
+    goto exit;
+
+malformed:
+    PyErr_SetString(DataError, "malformed array");
+
+exit:
+    PyMem_Free(buf);
+    return rv;
+}
+
+/* Cast an array whose elements are converted by the C function `cast`.
+ *
+ * If the array typecaster has a different base (e.g. it was created from
+ * Python) use the generic parser instead.
+ */
+static PyObject *
+typecast_array_fast(const char *str, Py_ssize_t len, PyObject *curs,
+                    typecast_function cast)
+{
+    PyObject *obj = NULL;
+    PyObject *base = ((typecastObject*)((cursorObject*)curs)->caster)->bcast;
+
+    if (!(base && PyObject_TypeCheck(base, &typecastType))
+            || ((typecastObject *)base)->ccast != cast) {
+        return typecast_GENERIC_ARRAY_cast(str, len, curs);
+    }
+
+    if (str == NULL) { Py_RETURN_NONE; }
+    if (str[0] == '[')
+        typecast_array_cleanup(&str, &len);
+    if (len == 0 || str[0] != '{') {
+        PyErr_SetString(DataError, "array does not start with '{'");
+        return NULL;
+    }
+
+    if (!(obj = PyList_New(0))) { return NULL; }
+
+    if (typecast_array_scan_fast(str, len, curs, cast, obj) < 0) {
+        Py_CLEAR(obj);
+    }
+
+    return obj;
+}
+
+static PyObject *
+typecast_INTEGERARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    return typecast_array_fast(str, len, curs, typecast_INTEGER_cast);
+}
+
+static PyObject *
+typecast_LONGINTEGERARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    return typecast_array_fast(str, len, curs, typecast_LONGINTEGER_cast);
+}
+
+static PyObject *
+typecast_FLOATARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    return typecast_array_fast(str, len, curs, typecast_FLOAT_cast);
+}
+
+static PyObject *
+typecast_BOOLEANARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    return typecast_array_fast(str, len, curs, typecast_BOOLEAN_cast);
+}
+
+static PyObject *
+typecast_UNICODEARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    return typecast_array_fast(str, len, curs, typecast_UNICODE_cast);
+}
+
+#if PY_MAJOR_VERSION < 3
+static PyObject *
+typecast_STRINGARRAY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    return typecast_array_fast(str, len, curs, typecast_STRING_cast);
+}
+#else
+#define typecast_STRINGARRAY_cast typecast_UNICODEARRAY_cast
+#endif
+
+
+/** PYARRAY - return 1-D numeric arrays as array.array objects
+ *
+ * Arrays with more dimensions or containing NULLs are returned as lists.
+ */
+
+/* Parse the 1-D array of numbers `str` into the buffer `out`, which must
+ * have room for as many numbers as the elements of the array, as values of
+ * the typecode `code` ('i', 'l', 'q' or 'd').
+ *
+ * Return the number of elements parsed, or -1 if the array is not in the
+ * simple form (without setting an exception).
+ */
+static Py_ssize_t
+typecast_array_parse_numbers(const char *str, Py_ssize_t len,
+                             char code, char *out)
+{
+    const char *end = str + len - 1;
+    const char *p = str + 1;
+    const char *token;
+    char *tend;
+    Py_ssize_t n = 0;
+    PY_LONG_LONG lval;
+    double dval;
+
+    if (len < 2 || *end != '}') { return -1; }
+    if (p == end) { return 0; }
+
+    while (1) {
+        token = p;
+        while (p < end && *p != ',') { p++; }
+        if (p == token) { return -1; }
+
+        if (code == 'd') {
+            if (*token == '{' || *token == '"') { return -1; }
+            dval = PyOS_string_to_double(token, &tend, NULL);
+            if (tend != p) {
+                PyErr_Clear();
+                return -1;
+            }
+            memcpy(out + n * sizeof(double), &dval, sizeof(double));
+        }
+        else {
+            if (0 != typecast_parse_int(token, p - token, &lval)) {
+                return -1;
+            }
+            if (code == 'i') {
+                int ival = (int)lval;
+                if (lval < INT_MIN || lval > INT_MAX) { return -1; }
+                memcpy(out + n * sizeof(int), &ival, sizeof(int));
+            }
+            else if (code == 'l') {
+                long ival = (long)lval;
+                memcpy(out + n * sizeof(long), &ival, sizeof(long));
+            }
+            else {
+                memcpy(out + n * sizeof(PY_LONG_LONG), &lval,
+                    sizeof(PY_LONG_LONG));
+            }
+        }
+        n++;
+
+        if (p == end) { break; }
+        p++;
+    }
+
+    return n;
+}
+
+/* Arrays of one zero of the typecodes in pyarray_codes, repeated to create
+ * the arrays to parse the numbers into */
+static const char pyarray_codes[] = "ilqd";
+static PyObject *pyarray_zeros[sizeof(pyarray_codes) - 1] = {NULL};
+
+/* Return a new array.array of `n` zeros of the typecode `code` */
+static PyObject *
+typecast_array_pyarray_new(char code, Py_ssize_t n)
+{
+    PyObject *m, *type;
+    char typecode[2];
+    int i;
+
+    i = (int)(strchr(pyarray_codes, code) - pyarray_codes);
+    if (!pyarray_zeros[i]) {
+        if (!(m = PyImport_ImportModule("array"))) { return NULL; }
+        type = PyObject_GetAttrString(m, "array");
+        Py_DECREF(m);
+        if (!type) { return NULL; }
+
+        typecode[0] = code;
+        typecode[1] = '\0';
+        pyarray_zeros[i] = PyObject_CallFunction(type, "s[i]", typecode, 0);
+        Py_DECREF(type);
+        if (!pyarray_zeros[i]) { return NULL; }
+    }
+
+    return PySequence_Repeat(pyarray_zeros[i], n);
+}
+
+static PyObject *
+typecast_array_pyarray(const char *str, Py_ssize_t len, PyObject *curs,
+                       typecast_function cast, char code)
+{
+    PyObject *rv = NULL;
+    Py_ssize_t i, n = 1, parsed;
+#if PY_MAJOR_VERSION < 3
+    void *buf;
+    Py_ssize_t buflen;
+#else
+    Py_buffer view;
+#endif
+
+    if (str == NULL) { Py_RETURN_NONE; }
+    if (str[0] != '{') { goto fallback; }
+
+    /* in the simple form there is an element more than the separators */
+    if (len == 2) {
+        n = 0;
+    }
+    else {
+        for (i = 0; i < len; i++) {
+            if (str[i] == ',') { n++; }
+        }
+    }
+
+    /* parse the numbers straight into the array buffer */
+    if (!(rv = typecast_array_pyarray_new(code, n))) { return NULL; }
+#if PY_MAJOR_VERSION < 3
+    if (0 > PyObject_AsWriteBuffer(rv, &buf, &buflen)) {
+        Py_CLEAR(rv);
+        return NULL;
+    }
+    parsed = typecast_array_parse_numbers(str, len, code, (char *)buf);
+#else
+    if (0 > PyObject_GetBuffer(rv, &view, PyBUF_WRITABLE)) {
+        Py_CLEAR(rv);
+        return NULL;
+    }
+    parsed = typecast_array_parse_numbers(str, len, code, (char *)view.buf);
+    PyBuffer_Release(&view);
+#endif
+    if (parsed == n) { return rv; }
+    Py_CLEAR(rv);
+
+fallback:
+    return typecast_array_fast(str, len, curs, cast);
+}
+
+static PyObject *
+typecast_INTEGERARRAY_PYARRAY_cast(const char *str, Py_ssize_t len,
+                                   PyObject *curs)
+{
+    return typecast_array_pyarray(str, len, curs, typecast_INTEGER_cast, 'i');
+}
+
+static PyObject *
+typecast_LONGINTEGERARRAY_PYARRAY_cast(const char *str, Py_ssize_t len,
+                                       PyObject *curs)
+{
+#if PY_MAJOR_VERSION >= 3
+    return typecast_array_pyarray(
+        str, len, curs, typecast_LONGINTEGER_cast, 'q');
+#else
+    /* array in Python 2 has no 'q' typecode */
+    if (sizeof(long) < sizeof(PY_LONG_LONG)) {
+        return typecast_array_fast(str, len, curs, typecast_LONGINTEGER_cast);
+    }
+    return typecast_array_pyarray(
+        str, len, curs, typecast_LONGINTEGER_cast, 'l');
+#endif
+}
+
+static PyObject *
+typecast_FLOATARRAY_PYARRAY_cast(const char *str, Py_ssize_t len,
+                                 PyObject *curs)
+{
+    return typecast_array_pyarray(str, len, curs, typecast_FLOAT_cast, 'd');
+}
+
+
+/** the other basic array typecasters are derived from GENERIC **/
 
-#define typecast_LONGINTEGERARRAY_cast typecast_GENERIC_ARRAY_cast
-#define typecast_INTEGERARRAY_cast typecast_GENERIC_ARRAY_cast
-#define typecast_FLOATARRAY_cast typecast_GENERIC_ARRAY_cast
 #define typecast_DECIMALARRAY_cast typecast_GENERIC_ARRAY_cast
-#define typecast_STRINGARRAY_cast typecast_GENERIC_ARRAY_cast
-#define typecast_UNICODEARRAY_cast typecast_GENERIC_ARRAY_cast
-#define typecast_BOOLEANARRAY_cast typecast_GENERIC_ARRAY_cast
 #define typecast_DATETIMEARRAY_cast typecast_GENERIC_ARRAY_cast
 #define typecast_DATETIMETZARRAY_cast typecast_GENERIC_ARRAY_cast
 #define typecast_DATEARRAY_cast typecast_GENERIC_ARRAY_cast
@@ -23,20 +23,89 @@
  * License for more details.
  */
 
+/* Parse a decimal integer in the buffer 's' of size 'len'.
+ *
+ * The string must be an optional sign followed by digits only, which is what
+ * the server emits for the integer types. Store the result in 'val' and
+ * return 0 on success. Return -1 if the string is not in that form or if the
+ * value doesn't fit a long long: in this case the caller should fall back to
+ * the slower (but more tolerant) Python parser. Don't set exceptions.
+ */
+static int
+typecast_parse_int(const char *s, Py_ssize_t len, PY_LONG_LONG *val)
+{
+    unsigned PY_LONG_LONG acc = 0, lim;
+    const char *end = s + len;
+    int neg = 0;
+
+    if (len > 0 && (*s == '-' || *s == '+')) {
+        neg = (*s == '-');
+        s++;
+    }
+    if (s == end) { return -1; }
+
+    lim = neg ? (unsigned PY_LONG_LONG)PY_LLONG_MAX + 1 : PY_LLONG_MAX;
+    for (; s < end; s++) {
+        unsigned int d = (unsigned int)(*s - '0');
+        if (d > 9) { return -1; }
+        if (acc > (lim - d) / 10) { return -1; }
+        acc = acc * 10 + d;
+    }
+
+    /* avoid -acc: it overflows for PY_LLONG_MIN */
+    *val = neg ? (PY_LONG_LONG)(0 - acc) : (PY_LONG_LONG)acc;
+    return 0;
+}
+
+/* Parse an integer using the Python parser, for what the fast path can't
+ * handle (very big numbers, spaces...). If 'as_long' is false return a Python
+ * 2 int where possible.
+ */
+static PyObject *
+typecast_parse_int_slow(const char *s, Py_ssize_t len, int as_long)
+{
+    PyObject *rv;
+    char buffer[32];
+    char *tmp = NULL;
+
+    if (s[len] != '\0') {
+        if (len < (Py_ssize_t)sizeof(buffer)) {
+            tmp = buffer;
+        }
+        else if (!(tmp = PyMem_Malloc(len + 1))) {
+            return PyErr_NoMemory();
+        }
+        memcpy(tmp, s, (size_t)len);
+        tmp[len] = '\0';
+        s = tmp;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (!as_long) {
+        rv = PyInt_FromString((char *)s, NULL, 0);
+    }
+    else
+#endif
+    {
+        rv = PyLong_FromString((char *)s, NULL, 0);
+    }
+    if (tmp != buffer) { PyMem_Free(tmp); }
+    return rv;
+}
+
 /** INTEGER - cast normal integers (4 bytes) to python int **/
 
 #if PY_MAJOR_VERSION < 3
 static PyObject *
 typecast_INTEGER_cast(const char *s, Py_ssize_t len, PyObject *curs)
 {
-    char buffer[12];
+    PY_LONG_LONG val;
 
     if (s == NULL) { Py_RETURN_NONE; }
-    if (s[len] != '\0') {
-        strncpy(buffer, s, (size_t) len); buffer[len] = '\0';
-        s = buffer;
+    if (0 == typecast_parse_int(s, len, &val)
+            && val >= LONG_MIN && val <= LONG_MAX) {
+        return PyInt_FromLong((long)val);
     }
-    return PyInt_FromString((char *)s, NULL, 0);
+    return typecast_parse_int_slow(s, len, 0);
 }
 #else
 #define typecast_INTEGER_cast typecast_LONGINTEGER_cast
@@ -47,14 +116,13 @@ typecast_INTEGER_cast(const char *s, Py_ssize_t len, PyObject *curs)
 static PyObject *
 typecast_LONGINTEGER_cast(const char *s, Py_ssize_t len, PyObject *curs)
 {
-    char buffer[24];
+    PY_LONG_LONG val;
 
     if (s == NULL) { Py_RETURN_NONE; }
-    if (s[len] != '\0') {
-        strncpy(buffer, s, (size_t) len); buffer[len] = '\0';
-        s = buffer;
+    if (0 == typecast_parse_int(s, len, &val)) {
+        return PyLong_FromLongLong(val);
     }
-    return PyLong_FromString((char *)s, NULL, 0);
+    return typecast_parse_int_slow(s, len, 1);
 }
 
 /** FLOAT - cast floating point numbers to python float **/
@@ -63,8 +131,21 @@ static PyObject *
 typecast_FLOAT_cast(const char *s, Py_ssize_t len, PyObject *curs)
 {
     PyObject *str = NULL, *flo = NULL;
+    char *end;
+    double d;
 
     if (s == NULL) { Py_RETURN_NONE; }
+
+    /* Fast path: parse the buffer in place. The string is not necessarily
+     * null-terminated (e.g. array items) so check that the number stops
+     * exactly at its end. */
+    d = PyOS_string_to_double(s, &end, NULL);
+    if (end == s + len && !(d == -1.0 && PyErr_Occurred())) {
+        return PyFloat_FromDouble(d);
+    }
+    PyErr_Clear();
+
+    /* Let Python deal with what we don't understand */
     if (!(str = Text_FromUTF8AndSize(s, len))) { return NULL; }
 #if PY_MAJOR_VERSION < 3
     flo = PyFloat_FromString(str, NULL);
@@ -126,27 +207,52 @@ typecast_DECIMAL_cast(const char *s, Py_ssize_t len, PyObject *curs)
 {
     PyObject *res = NULL;
     PyObject *decimalType;
-    char *buffer;
+    PyObject *str;
 
     if (s == NULL) { Py_RETURN_NONE; }
 
-    if ((buffer = PyMem_Malloc(len+1)) == NULL)
-        return PyErr_NoMemory();
-    strncpy(buffer, s, (size_t) len); buffer[len] = '\0';
-    decimalType = psyco_GetDecimalType();
+    if (!(str = Text_FromUTF8AndSize(s, len))) { return NULL; }
+
     /* Fall back on float if decimal is not available */
-    if (decimalType != NULL) {
-        res = PyObject_CallFunction(decimalType, "s", buffer);
+    if ((decimalType = psyco_GetDecimalType())) {
+        res = psyco_Vectorcall(decimalType, &str, 1, NULL);
         Py_DECREF(decimalType);
     }
     else {
-        res = PyObject_CallFunction((PyObject*)&PyFloat_Type, "s", buffer);
+#if PY_MAJOR_VERSION < 3
+        res = PyFloat_FromString(str, NULL);
+#else
+        res = PyFloat_FromString(str);
+#endif
     }
-    PyMem_Free(buffer);
+    Py_DECREF(str);
 
     return res;
 }
 
+/** DEC2NUMBER - cast numeric values into int or float, skipping Decimal **/
+
+static PyObject *
+typecast_DEC2NUMBER_cast(const char *s, Py_ssize_t len, PyObject *curs)
+{
+    Py_ssize_t i;
+
+    if (s == NULL) { Py_RETURN_NONE; }
+
+    /* Values without a fractional part (such as the ones from a numeric
+     * column with scale 0) become int, anything else (including NaN) float. */
+    i = (len > 0 && (s[0] == '-' || s[0] == '+')) ? 1 : 0;
+    if (i == len) {
+        return typecast_FLOAT_cast(s, len, curs);
+    }
+    for (; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return typecast_FLOAT_cast(s, len, curs);
+        }
+    }
+    return typecast_INTEGER_cast(s, len, curs);
+}
+
 /* some needed aliases */
 #define typecast_NUMBER_cast   typecast_FLOAT_cast
 #define typecast_ROWID_cast    typecast_INTEGER_cast
@@ -27,6 +27,9 @@
 
 #include <stdlib.h>
 
+/* Release the GIL while decoding values bigger than this */
+#define HEX_NOGIL_THRESHOLD (64 * 1024)
+
 
 /* Python object holding a memory chunk. The memory is deallocated when
    the object is destroyed. This type is used to let users directly access
@@ -40,7 +43,12 @@ chunk_dealloc(chunkObject *self)
         FORMAT_CODE_PY_SSIZE_T,
         self->base, self->len
       );
-    PyMem_Free(self->base);
+    if (self->owner) {
+        Py_DECREF(self->owner);
+    }
+    else {
+        PyMem_Free(self->base);
+    }
     Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
@@ -132,17 +140,107 @@ PyTypeObject chunkType = {
 };
 
 
+/* Python object owning a PGresult. The result is cleared when the object is
+   destroyed, so chunks can point into the result memory and outlive the
+   cursor that received it.
+ */
+
+static void
+pgresult_dealloc(pgresultObject *self)
+{
+    Dprintf("pgresult_dealloc: clearing result at %p", self->pgres);
+    PQclear(self->pgres);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+#define pgresult_doc "query result memory"
+
+PyTypeObject pgresultType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "psycopg2._psycopg.pgresult",
+    sizeof(pgresultObject), 0,
+    (destructor) pgresult_dealloc, /* tp_dealloc*/
+    0,                          /* tp_print */
+    0,                          /* tp_getattr */
+    0,                          /* tp_setattr */
+    0,                          /* tp_compare */
+    0,                          /* tp_repr */
+    0,                          /* tp_as_number */
+    0,                          /* tp_as_sequence */
+    0,                          /* tp_as_mapping */
+    0,                          /* tp_hash */
+    0,                          /* tp_call */
+    0,                          /* tp_str */
+    0,                          /* tp_getattro */
+    0,                          /* tp_setattro */
+    0,                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,         /* tp_flags */
+    pgresult_doc                /* tp_doc */
+};
+
+/* Return a new pgresult object taking ownership of `pgres`.
+ *
+ * On error the result is not cleared.
+ */
+PyObject *
+pgresult_new(PGresult *pgres)
+{
+    pgresultObject *self;
+
+    if (!(self = PyObject_New(pgresultObject, &pgresultType))) {
+        return NULL;
+    }
+    self->pgres = pgres;
+    return (PyObject *)self;
+}
+
+
 static char *psycopg_parse_hex(
         const char *bufin, Py_ssize_t sizein, Py_ssize_t *sizeout);
 static char *psycopg_parse_escape(
         const char *bufin, Py_ssize_t sizein, Py_ssize_t *sizeout);
 
+/* Return a read-only buffer object exposing `len` bytes at `buffer`.
+ *
+ * If `owner` is NULL take the ownership of `buffer`, which must have been
+ * allocated by PyMem_Malloc, and free it on error. Otherwise the memory
+ * belongs to `owner`, which is kept alive as long as the view.
+ */
+static PyObject *
+_binary_view(char *buffer, Py_ssize_t len, PyObject *owner)
+{
+    chunkObject *chunk = NULL;
+    PyObject *res = NULL;
+
+    chunk = (chunkObject *) PyObject_New(chunkObject, &chunkType);
+    if (chunk == NULL) goto exit;
+
+    /* **Transfer** ownership of buffer's memory to the chunkObject: */
+    chunk->base = buffer;
+    chunk->len = len;
+    chunk->owner = owner;
+    Py_XINCREF(owner);
+    buffer = NULL;
+
+#if PY_MAJOR_VERSION < 3
+    if ((res = PyBuffer_FromObject((PyObject *)chunk, 0, chunk->len)) == NULL)
+        goto exit;
+#else
+    if ((res = PyMemoryView_FromObject((PyObject*)chunk)) == NULL)
+        goto exit;
+#endif
+
+exit:
+    Py_XDECREF((PyObject *)chunk);
+    if (!owner) { PyMem_Free(buffer); }
+
+    return res;
+}
+
 /* The function is not static and not hidden as we use ctypes to test it. */
 PyObject *
 typecast_BINARY_cast(const char *s, Py_ssize_t l, PyObject *curs)
 {
-    chunkObject *chunk = NULL;
-    PyObject *res = NULL;
     char *buffer = NULL;
     Py_ssize_t len;
 
@@ -155,7 +253,7 @@ typecast_BINARY_cast(const char *s, Py_ssize_t l, PyObject *curs)
          * an easy format.
          */
         if (NULL == (buffer = psycopg_parse_hex(s, l, &len))) {
-            goto exit;
+            return NULL;
         }
     }
     else {
@@ -170,31 +268,39 @@ typecast_BINARY_cast(const char *s, Py_ssize_t l, PyObject *curs)
          * story.
          */
         if (NULL == (buffer = psycopg_parse_escape(s, l, &len))) {
-            goto exit;
+            return NULL;
         }
     }
 
-    chunk = (chunkObject *) PyObject_New(chunkObject, &chunkType);
-    if (chunk == NULL) goto exit;
+    return _binary_view(buffer, len, NULL);
+}
 
-    /* **Transfer** ownership of buffer's memory to the chunkObject: */
-    chunk->base = buffer;
-    buffer = NULL;
-    chunk->len = (Py_ssize_t)len;
+/* Cast a bytea value received in binary format.
+ *
+ * The data needs no unescaping: if it comes from the cursor result, return
+ * a view on the result memory, which is kept alive until the last view is
+ * released. Otherwise return a view on a copy of it.
+ */
+static PyObject *
+typecast_BYTEABINARY_cast(const char *s, Py_ssize_t l, PyObject *curs)
+{
+    PyObject *owner;
+    char *buffer;
 
-#if PY_MAJOR_VERSION < 3
-    if ((res = PyBuffer_FromObject((PyObject *)chunk, 0, chunk->len)) == NULL)
-        goto exit;
-#else
-    if ((res = PyMemoryView_FromObject((PyObject*)chunk)) == NULL)
-        goto exit;
-#endif
+    if (s == NULL) { Py_RETURN_NONE; }
 
-exit:
-    Py_XDECREF((PyObject *)chunk);
-    PyMem_Free(buffer);
+    if (curs_value_in_result((cursorObject *)curs, s)) {
+        if (!(owner = curs_get_pgres_owner((cursorObject *)curs))) {
+            return NULL;
+        }
+        return _binary_view((char *)s, l, owner);
+    }
 
-    return res;
+    if (!(buffer = PyMem_Malloc(l ? l : 1))) {
+        return PyErr_NoMemory();
+    }
+    memcpy(buffer, s, l);
+    return _binary_view(buffer, l, NULL);
 }
 
 
@@ -209,6 +315,97 @@ static const char hex_lut[128] = {
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
 };
 
+#ifdef PSYCOPG_HAVE_SSE2
+
+/* Convert 16 hex digits into their nibble values, as 16-bit lanes holding
+ * the high nibble in the low byte and the low nibble in the high byte.
+ * Set `valid` to 0 if any char is not a hex digit. */
+static __m128i
+_hex_nibbles(__m128i v, int *valid)
+{
+    __m128i lv, is_digit, is_alpha;
+
+    is_digit = _mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    lv = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    is_alpha = _mm_and_si128(
+        _mm_cmpgt_epi8(lv, _mm_set1_epi8('a' - 1)),
+        _mm_cmplt_epi8(lv, _mm_set1_epi8('f' + 1)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xFFFF) {
+        *valid = 0;
+    }
+
+    return _mm_or_si128(
+        _mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+        _mm_and_si128(is_alpha, _mm_sub_epi8(lv, _mm_set1_epi8('a' - 10))));
+}
+
+/* Decode the hex digits in `pi` into `po` 32 chars at time.
+ *
+ * Stop at the first block containing anything else than hex digits, and
+ * return the number of chars consumed.
+ */
+static Py_ssize_t
+_parse_hex_sse2(const char *pi, Py_ssize_t sizein, char *po)
+{
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    __m128i n1, n2;
+    Py_ssize_t i;
+    int valid = 1;
+
+    for (i = 0; i + 32 <= sizein; i += 32) {
+        n1 = _hex_nibbles(_mm_loadu_si128((const __m128i *)(pi + i)), &valid);
+        n2 = _hex_nibbles(
+            _mm_loadu_si128((const __m128i *)(pi + i + 16)), &valid);
+        if (!valid) { break; }
+
+        /* (high << 4) | low in the low byte of every lane, then pack */
+        n1 = _mm_and_si128(
+            _mm_or_si128(_mm_slli_epi16(n1, 4), _mm_srli_epi16(n1, 8)), mask);
+        n2 = _mm_and_si128(
+            _mm_or_si128(_mm_slli_epi16(n2, 4), _mm_srli_epi16(n2, 8)), mask);
+        _mm_storeu_si128((__m128i *)(po + i / 2), _mm_packus_epi16(n1, n2));
+    }
+
+    return i;
+}
+
+#endif
+
+/* Decode the hex digits between `pi` and `bufend` into `po`, skipping
+ * anything else, and return the number of bytes written. */
+static Py_ssize_t
+_parse_hex(const char *pi, const char *bufend, char *po)
+{
+    char *bufout = po;
+
+#ifdef PSYCOPG_HAVE_SSE2
+    {
+        Py_ssize_t n = _parse_hex_sse2(pi, bufend - pi, po);
+        pi += n;
+        po += n / 2;
+    }
+#endif
+
+    while (pi < bufend) {
+        char c;
+        while (-1 == (c = hex_lut[*pi++ & '\x7f'])) {
+            if (pi >= bufend) { goto endloop; }
+        }
+        *po = c << 4;
+
+        while (-1 == (c = hex_lut[*pi++ & '\x7f'])) {
+            if (pi >= bufend) { goto endloop; }
+        }
+        *po++ |= c;
+    }
+endloop:
+
+    return po - bufout;
+}
+
 /* Parse a bytea output buffer encoded in 'hex' format.
  *
  * the format is described in
@@ -217,20 +414,20 @@ static const char hex_lut[128] = {
  * Parse the buffer in 'bufin', whose length is 'sizein'.
  * Return a new buffer allocated by PyMem_Malloc and set 'sizeout' to its size.
  * In case of error set an exception and return NULL.
+ *
+ * Big values are decoded with the GIL released.
  */
 static char *
 psycopg_parse_hex(const char *bufin, Py_ssize_t sizein, Py_ssize_t *sizeout)
 {
-    char *ret = NULL;
     const char *bufend = bufin + sizein;
     const char *pi = bufin + 2;     /* past the \x */
     char *bufout;
-    char *po;
 
-    po = bufout = PyMem_Malloc((sizein - 2) >> 1);   /* output size upper bound */
+    bufout = PyMem_Malloc((sizein - 2) >> 1);   /* output size upper bound */
     if (NULL == bufout) {
         PyErr_NoMemory();
-        goto exit;
+        return NULL;
     }
 
     /* Implementation note: we call this function upon database response, not
@@ -238,25 +435,16 @@ psycopg_parse_hex(const char *bufin, Py_ssize_t sizein, Py_ssize_t *sizeout)
      * don't expect errors. On bad input we reserve the right to return a bad
      * output, not an error.
      */
-    while (pi < bufend) {
-        char c;
-        while (-1 == (c = hex_lut[*pi++ & '\x7f'])) {
-            if (pi >= bufend) { goto endloop; }
-        }
-        *po = c << 4;
-
-        while (-1 == (c = hex_lut[*pi++ & '\x7f'])) {
-            if (pi >= bufend) { goto endloop; }
-        }
-        *po++ |= c;
+    if (sizein < HEX_NOGIL_THRESHOLD) {
+        *sizeout = _parse_hex(pi, bufend, bufout);
+    }
+    else {
+        Py_BEGIN_ALLOW_THREADS;
+        *sizeout = _parse_hex(pi, bufend, bufout);
+        Py_END_ALLOW_THREADS;
     }
-endloop:
-
-    ret = bufout;
-    *sizeout = po - bufout;
 
-exit:
-    return ret;
+    return bufout;
 }
 
 /* Parse a bytea output buffer encoded in 'escape' format.
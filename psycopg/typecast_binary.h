@@ -39,9 +39,26 @@ typedef struct {
 
     void *base;     /* Pointer to the memory chunk. */
     Py_ssize_t len;        /* Size in bytes of the memory chunk. */
+    PyObject *owner;       /* Object owning the memory, if not the chunk. */
 
 } chunkObject;
 
+/** pgresult type **/
+
+extern HIDDEN PyTypeObject pgresultType;
+
+/* Python object owning a PGresult, cleared when the object is destroyed.
+   Used to keep the result alive while chunks point into its memory. */
+
+typedef struct {
+    PyObject_HEAD
+
+    PGresult *pgres;
+
+} pgresultObject;
+
+HIDDEN PyObject *pgresult_new(PGresult *pgres);
+
 #ifdef __cplusplus
 }
 #endif
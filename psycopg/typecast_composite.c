@@ -0,0 +1,181 @@
+/* typecast_composite.c - composite types typecaster
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+/* The composite typecaster is created by CompositeCaster, which is stored as
+ * the base of the typecaster. The attributes of the record are cast with the
+ * typecasters of the `atttypes` oids and passed as a list to its make().
+ */
+
+static PyObject *
+composite_error(const char *str, const char *p)
+{
+    PyErr_Format(InterfaceError,
+        "can't parse composite type at char %d", (int)(p - str));
+    return NULL;
+}
+
+/* Raise the error of CompositeCaster.parse() on a wrong number of fields */
+static void
+composite_count_error(PyObject *caster, Py_ssize_t exp, Py_ssize_t got)
+{
+    PyObject *name;
+
+    if (!(name = psycopg_ensure_bytes(
+            PyObject_GetAttrString(caster, "name")))) {
+        return;
+    }
+    PyErr_Format(DataError,
+        "expecting %d components for the type %s, %d found instead",
+        (int)exp, Bytes_AS_STRING(name), (int)got);
+    Py_DECREF(name);
+}
+
+static PyObject *composite_make_name = NULL;
+
+static PyObject *
+typecast_COMPOSITE_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    PyObject *caster = ((typecastObject*)((cursorObject*)curs)->caster)->bcast;
+    PyObject *tmp, *atttypes = NULL, *values = NULL, *val, *rv = NULL;
+    const char *p, *end, *token;
+    char *buf = NULL, *po;
+    Py_ssize_t ntypes, nvalues, tlen;
+
+    if (str == NULL) { Py_RETURN_NONE; }
+
+    if (!caster) {
+        PyErr_SetString(InterfaceError,
+            "the composite typecaster must be created by CompositeCaster");
+        goto exit;
+    }
+
+    if (len < 2 || str[0] != '(' || str[len - 1] != ')') {
+        composite_error(str, str);
+        goto exit;
+    }
+
+    if (!(tmp = PyObject_GetAttrString(caster, "atttypes"))) { goto exit; }
+    atttypes = PySequence_Fast(tmp, "atttypes must be a sequence");
+    Py_DECREF(tmp);
+    if (!atttypes) { goto exit; }
+    ntypes = PySequence_Fast_GET_SIZE(atttypes);
+
+    if (!(values = PyList_New(0))) { goto exit; }
+
+    /* the fields are never longer than the literal */
+    if (!(buf = PyMem_Malloc(len + 1))) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    /* scan the fields between the parens: an empty field is NULL */
+    p = str + 1;
+    end = str + len - 1;
+    while (1) {
+        if (p >= end || *p == ',') {
+            token = NULL;
+            tlen = 0;
+        }
+        else if (*p == '"') {
+            po = buf;
+            for (p++; ; p++) {
+                if (p >= end) {
+                    composite_error(str, p);
+                    goto exit;
+                }
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') { p++; }
+                    else { break; }
+                }
+                else if (*p == '\\') {
+                    if (++p >= end) {
+                        composite_error(str, p);
+                        goto exit;
+                    }
+                }
+                *po++ = *p;
+            }
+            p++;
+            *po = '\0';
+            token = buf;
+            tlen = po - buf;
+        }
+        else {
+            /* copy the field too: the typecasters may expect a terminated
+             * string */
+            token = p;
+            while (p < end && *p != ',' && *p != '"') { p++; }
+            tlen = p - token;
+            memcpy(buf, token, tlen);
+            buf[tlen] = '\0';
+            token = buf;
+        }
+
+        if (p < end && *p != ',') {
+            composite_error(str, p);
+            goto exit;
+        }
+
+        nvalues = PyList_GET_SIZE(values);
+        if (nvalues < ntypes) {
+            val = typecast_cast(
+                curs_get_cast((cursorObject *)curs,
+                    PySequence_Fast_GET_ITEM(atttypes, nvalues)),
+                token, tlen, curs);
+            if (!val) { goto exit; }
+        }
+        else {
+            /* too many fields: only count them to report the error */
+            Py_INCREF(Py_None);
+            val = Py_None;
+        }
+        if (0 != PyList_Append(values, val)) {
+            Py_DECREF(val);
+            goto exit;
+        }
+        Py_DECREF(val);
+
+        if (p >= end) { break; }
+        p++;    /* the comma */
+    }
+
+    if (PyList_GET_SIZE(values) != ntypes) {
+        composite_count_error(caster, ntypes, PyList_GET_SIZE(values));
+        goto exit;
+    }
+
+    if (!composite_make_name) {
+        if (!(composite_make_name = Text_InternFromString("make"))) {
+            goto exit;
+        }
+    }
+    rv = PyObject_CallMethodObjArgs(caster, composite_make_name, values, NULL);
+
+exit:
+    PyMem_Free(buf);
+    Py_XDECREF(values);
+    Py_XDECREF(atttypes);
+    return rv;
+}
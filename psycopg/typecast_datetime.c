@@ -40,6 +40,86 @@ psyco_typecast_datetime_init(void)
     return 0;
 }
 
+/* The datetime C API constructors don't validate their arguments on every
+ * Python version: use them only on valid values, else call the type, which
+ * raises the appropriate error. */
+
+static int
+_valid_date(int y, int m, int d)
+{
+    static const int mdays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    if (y < 1 || y > 9999 || m < 1 || m > 12 || d < 1) { return 0; }
+    if (d <= mdays[m - 1]) { return 1; }
+    return (m == 2 && d == 29 && y % 4 == 0 && (y % 100 != 0 || y % 400 == 0));
+}
+
+static int
+_valid_time(int hh, int mm, int ss, int us)
+{
+    return (hh >= 0 && hh < 24 && mm >= 0 && mm < 60
+        && ss >= 0 && ss < 60 && us >= 0 && us < 1000000);
+}
+
+/* Return a new reference to the tzinfo for an UTC offset in minutes.
+ *
+ * The objects returned by the cursor tzinfo_factory are cached for the
+ * lifetime of the current result. If the factory is datetime.timezone
+ * the objects are created with the C API.
+ */
+static PyObject *
+_get_tzinfo(cursorObject *curs, int offset)
+{
+    cursTzCache *cache = &curs->tzcache;
+    PyObject *tzinfo;
+    int i;
+
+    if (cache->factory != curs->tzinfo_factory) {
+        curs_tzcache_clear(curs);
+        Py_XINCREF(curs->tzinfo_factory);
+        cache->factory = curs->tzinfo_factory;
+    }
+
+    for (i = 0; i < TZCACHE_SIZE; i++) {
+        if (cache->tzinfos[i] && cache->offsets[i] == offset) {
+            Py_INCREF(cache->tzinfos[i]);
+            return cache->tzinfos[i];
+        }
+    }
+
+#if PY_VERSION_HEX >= 0x03070000
+    if (cache->factory == (PyObject *)Py_TYPE(PyDateTime_TimeZone_UTC)) {
+        PyObject *delta;
+
+        if (offset == 0) {
+            tzinfo = PyDateTime_TimeZone_UTC;
+            Py_INCREF(tzinfo);
+        }
+        else {
+            if (!(delta = PyDelta_FromDSU(0, offset * 60, 0))) {
+                return NULL;
+            }
+            tzinfo = PyTimeZone_FromOffset(delta);
+            Py_DECREF(delta);
+        }
+    }
+    else
+#endif
+    {
+        tzinfo = PyObject_CallFunction(cache->factory, "i", offset);
+    }
+    if (!tzinfo) { return NULL; }
+
+    i = cache->next;
+    cache->next = (i + 1) % TZCACHE_SIZE;
+    Py_XDECREF(cache->tzinfos[i]);
+    Py_INCREF(tzinfo);
+    cache->tzinfos[i] = tzinfo;
+    cache->offsets[i] = offset;
+
+    return tzinfo;
+}
+
 /** DATE - cast a date into a date python object **/
 
 static PyObject *
@@ -61,6 +141,11 @@ typecast_PYDATE_cast(const char *str, Py_ssize_t len, PyObject *curs)
         }
     }
 
+    else if (len == 10 && 0 == typecast_parse_iso_date(str, len, &y, &m, &d)
+            && _valid_date(y, m, d)) {
+        obj = PyDateTimeAPI->Date_FromDate(y, m, d, PyDateTimeAPI->DateType);
+    }
+
     else {
         n = typecast_parse_date(str, NULL, &len, &y, &m, &d);
         Dprintf("typecast_PYDATE_cast: "
@@ -105,7 +190,7 @@ _parse_inftz(const char *str, PyObject *curs)
         goto exit;
     }
 
-    if (!(tzinfo = PyObject_CallFunction(tzinfo_factory, "i", 0))) {
+    if (!(tzinfo = _get_tzinfo((cursorObject *)curs, 0))) {
         goto exit;
     }
 
@@ -133,10 +218,20 @@ _parse_noninftz(const char *str, Py_ssize_t len, PyObject *curs)
     PyObject *tzinfo = NULL;
     PyObject *tzinfo_factory;
     int n, y=0, m=0, d=0;
-    int hh=0, mm=0, ss=0, us=0, tz=0;
+    int hh=0, mm=0, ss=0, us=0, tz=0, hastz=0;
     const char *tp = NULL;
 
     Dprintf("typecast_PYDATETIMETZ_cast: s = %s", str);
+
+    /* fast path for the ISO layout, else use the generic parser */
+    if (0 == typecast_parse_iso_date(str, len, &y, &m, &d)
+            && (len == 10 || ((str[10] == ' ' || str[10] == 'T')
+                && 0 == typecast_parse_iso_time(str + 11, len - 11,
+                    &hh, &mm, &ss, &us, &tz, &hastz)))) {
+        goto build;
+    }
+    y = m = d = hh = mm = ss = us = tz = 0;
+
     n = typecast_parse_date(str, &tp, &len, &y, &m, &d);
     Dprintf("typecast_PYDATE_cast: tp = %p "
             "n = %d, len = " FORMAT_CODE_PY_SSIZE_T ","
@@ -157,6 +252,7 @@ _parse_noninftz(const char *str, Py_ssize_t len, PyObject *curs)
             PyErr_SetString(DataError, "unable to parse time");
             goto exit;
         }
+        hastz = (n >= 5);
     }
 
     if (ss > 59) {
@@ -166,8 +262,9 @@ _parse_noninftz(const char *str, Py_ssize_t len, PyObject *curs)
     if (y > 9999)
         y = 9999;
 
+build:
     tzinfo_factory = ((cursorObject *)curs)->tzinfo_factory;
-    if (n >= 5 && tzinfo_factory != Py_None) {
+    if (hastz && tzinfo_factory != Py_None) {
         /* we have a time zone, calculate minutes and create
            appropriate tzinfo object calling the factory */
         Dprintf("typecast_PYDATETIMETZ_cast: UTC offset = %ds", tz);
@@ -175,9 +272,8 @@ _parse_noninftz(const char *str, Py_ssize_t len, PyObject *curs)
         /* The datetime module requires that time zone offsets be
            a whole number of minutes, so truncate the seconds to the
            closest minute. */
-        // printf("%d %d %d\n", tz, tzmin, round(tz / 60.0));
-        if (!(tzinfo = PyObject_CallFunction(tzinfo_factory, "i",
-                (int)round(tz / 60.0)))) {
+        if (!(tzinfo = _get_tzinfo(
+                (cursorObject *)curs, (int)round(tz / 60.0)))) {
             goto exit;
         }
     } else {
@@ -188,9 +284,15 @@ _parse_noninftz(const char *str, Py_ssize_t len, PyObject *curs)
     Dprintf("typecast_PYDATETIMETZ_cast: tzinfo: %p, refcnt = "
         FORMAT_CODE_PY_SSIZE_T,
         tzinfo, Py_REFCNT(tzinfo));
-    rv = PyObject_CallFunction(
-        (PyObject*)PyDateTimeAPI->DateTimeType, "iiiiiiiO",
-        y, m, d, hh, mm, ss, us, tzinfo);
+    if (_valid_date(y, m, d) && _valid_time(hh, mm, ss, us)) {
+        rv = PyDateTimeAPI->DateTime_FromDateAndTime(
+            y, m, d, hh, mm, ss, us, tzinfo, PyDateTimeAPI->DateTimeType);
+    }
+    else {
+        rv = PyObject_CallFunction(
+            (PyObject*)PyDateTimeAPI->DateTimeType, "iiiiiiiO",
+            y, m, d, hh, mm, ss, us, tzinfo);
+    }
 
 exit:
     Py_XDECREF(tzinfo);
@@ -236,25 +338,31 @@ typecast_PYTIME_cast(const char *str, Py_ssize_t len, PyObject *curs)
     PyObject* obj = NULL;
     PyObject *tzinfo = NULL;
     PyObject *tzinfo_factory;
-    int n, hh=0, mm=0, ss=0, us=0, tz=0;
+    int n, hh=0, mm=0, ss=0, us=0, tz=0, hastz=0;
 
     if (str == NULL) { Py_RETURN_NONE; }
 
-    n = typecast_parse_time(str, NULL, &len, &hh, &mm, &ss, &us, &tz);
-    Dprintf("typecast_PYTIME_cast: n = %d, len = " FORMAT_CODE_PY_SSIZE_T ", "
-            "hh = %d, mm = %d, ss = %d, us = %d, tz = %d",
-            n, len, hh, mm, ss, us, tz);
+    if (0 != typecast_parse_iso_time(
+            str, len, &hh, &mm, &ss, &us, &tz, &hastz)) {
+        hh = mm = ss = 0;
+        n = typecast_parse_time(str, NULL, &len, &hh, &mm, &ss, &us, &tz);
+        Dprintf("typecast_PYTIME_cast: n = %d, len = "
+                FORMAT_CODE_PY_SSIZE_T ", "
+                "hh = %d, mm = %d, ss = %d, us = %d, tz = %d",
+                n, len, hh, mm, ss, us, tz);
 
-    if (n < 3 || n > 6) {
-        PyErr_SetString(DataError, "unable to parse time");
-        return NULL;
-    }
-    if (ss > 59) {
-        mm += 1;
-        ss -= 60;
+        if (n < 3 || n > 6) {
+            PyErr_SetString(DataError, "unable to parse time");
+            return NULL;
+        }
+        if (ss > 59) {
+            mm += 1;
+            ss -= 60;
+        }
+        hastz = (n >= 5);
     }
     tzinfo_factory = ((cursorObject *)curs)->tzinfo_factory;
-    if (n >= 5 && tzinfo_factory != Py_None) {
+    if (hastz && tzinfo_factory != Py_None) {
         /* we have a time zone, calculate minutes and create
            appropriate tzinfo object calling the factory */
         Dprintf("typecast_PYTIME_cast: UTC offset = %ds", tz);
@@ -262,15 +370,21 @@ typecast_PYTIME_cast(const char *str, Py_ssize_t len, PyObject *curs)
         /* The datetime module requires that time zone offsets be
            a whole number of minutes, so truncate the seconds to the
            closest minute. */
-        tzinfo = PyObject_CallFunction(tzinfo_factory, "i",
-            (int)round(tz / 60.0));
+        tzinfo = _get_tzinfo((cursorObject *)curs, (int)round(tz / 60.0));
     } else {
         Py_INCREF(Py_None);
         tzinfo = Py_None;
     }
     if (tzinfo != NULL) {
-        obj = PyObject_CallFunction((PyObject*)PyDateTimeAPI->TimeType, "iiiiO",
-                                    hh, mm, ss, us, tzinfo);
+        if (_valid_time(hh, mm, ss, us)) {
+            obj = PyDateTimeAPI->Time_FromTime(
+                hh, mm, ss, us, tzinfo, PyDateTimeAPI->TimeType);
+        }
+        else {
+            obj = PyObject_CallFunction(
+                (PyObject*)PyDateTimeAPI->TimeType, "iiiiO",
+                hh, mm, ss, us, tzinfo);
+        }
         Py_DECREF(tzinfo);
     }
     return obj;
@@ -313,6 +427,26 @@ exit:
 }
 
 
+/* Return a new timedelta from days, seconds and microseconds.
+ *
+ * Use the C API if the values are in range, else call the type, which
+ * raises the appropriate error.
+ */
+static PyObject *
+interval_from_dsu(PY_LONG_LONG days, PY_LONG_LONG seconds, long micros)
+{
+    days += seconds / 86400;
+    seconds %= 86400;
+
+    if (days < -999999999 || days > 999999999) {
+        return PyObject_CallFunction((PyObject*)PyDateTimeAPI->DeltaType,
+            "LLl", days, seconds, micros);
+    }
+
+    return PyDelta_FromDSU((int)days, (int)seconds, (int)micros);
+}
+
+
 /** INTERVAL - parse an interval into a timedelta object **/
 
 static PyObject *
@@ -452,8 +586,41 @@ typecast_PYINTERVAL_cast(const char *str, Py_ssize_t len, PyObject *curs)
     /* add the days, months years together - they already include a sign */
     days += 30 * (PY_LONG_LONG)months + 365 * (PY_LONG_LONG)years;
 
-    return PyObject_CallFunction((PyObject*)PyDateTimeAPI->DeltaType, "LLl",
-                                 days, seconds, micros);
+    return interval_from_dsu(days, seconds, micros);
+}
+
+/** INTERVAL - parse a binary interval into a timedelta object
+ *
+ * The binary format is made of 64 bits of microseconds, 32 bits of days and
+ * 32 bits of months, in network order.
+ */
+
+static PyObject *
+typecast_PYINTERVALBINARY_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    const unsigned char *p = (const unsigned char *)str;
+    PY_LONG_LONG usecs;
+    int days, months;
+    unsigned PY_LONG_LONG u = 0;
+    int i;
+
+    if (str == NULL) { Py_RETURN_NONE; }
+
+    if (len != 16) {
+        PyErr_SetString(DataError, "bad binary interval length");
+        return NULL;
+    }
+
+    for (i = 0; i < 8; i++) { u = (u << 8) | p[i]; }
+    usecs = (PY_LONG_LONG)u;
+    days = (int)(((unsigned int)p[8] << 24) | ((unsigned int)p[9] << 16)
+        | ((unsigned int)p[10] << 8) | (unsigned int)p[11]);
+    months = (int)(((unsigned int)p[12] << 24) | ((unsigned int)p[13] << 16)
+        | ((unsigned int)p[14] << 8) | (unsigned int)p[15]);
+
+    return interval_from_dsu(
+        days + 30 * (PY_LONG_LONG)months,
+        usecs / 1000000, (long)(usecs % 1000000));
 }
 
 /* psycopg defaults to using python datetime types */
@@ -0,0 +1,192 @@
+/* typecast_hstore.c - hstore typecasters
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+/* The hstore output is a list of pairs such as:
+ *
+ *     "a"=>"1", "b"=>NULL
+ *
+ * with the keys and values backslash-escaped. The parser accepts what
+ * HstoreAdapter.parse() accepts, going over the data only once: no space
+ * before the first pair or after the last one, but a trailing comma.
+ */
+
+/* Write the string in `s` without the backslashes; return its length */
+static Py_ssize_t
+hstore_unescape(const char *s, Py_ssize_t len, char *out)
+{
+    const char *end = s + len;
+    char *po = out;
+
+    for (; s < end; s++) {
+        if (*s == '\\') { s++; }
+        *po++ = *s;
+    }
+    return po - out;
+}
+
+/* Scan a quoted string starting at *pp; return a new string object or NULL.
+ *
+ * Return NULL without an exception set if the data is not a quoted string.
+ */
+static PyObject *
+hstore_parse_string(const char **pp, const char *end, cursorObject *curs,
+                    int unicode)
+{
+    const char *p = *pp, *s;
+    char *tmp = NULL;
+    int escaped = 0;
+    PyObject *rv = NULL;
+
+    if (p >= end || *p != '"') { return NULL; }
+
+    s = ++p;
+    while (p < end && *p != '"') {
+        if (*p == '\\') {
+            /* as in parse(), where '.' doesn't match a newline */
+            if (p + 1 < end && p[1] == '\n') { return NULL; }
+            escaped = 1;
+            p++;
+        }
+        p++;
+    }
+    if (p >= end) { return NULL; }
+    *pp = p + 1;
+
+    /* escaped strings are rare: no point in a stack buffer */
+    if (escaped) {
+        if (!(tmp = PyMem_Malloc(p - s))) {
+            return PyErr_NoMemory();
+        }
+        p = tmp + hstore_unescape(s, p - s, tmp);
+        s = tmp;
+    }
+
+#if PY_MAJOR_VERSION < 3
+    if (!unicode) {
+        rv = PyString_FromStringAndSize(s, p - s);
+    }
+    else
+#endif
+    {
+        rv = conn_decode(curs->conn, s, p - s);
+    }
+
+    PyMem_Free(tmp);
+    return rv;
+}
+
+static void
+hstore_skip_ws(const char **pp, const char *end)
+{
+    const char *p = *pp;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'
+            || *p == '\f' || *p == '\v')) {
+        p++;
+    }
+    *pp = p;
+}
+
+static PyObject *
+hstore_parse(const char *str, Py_ssize_t len, cursorObject *curs, int unicode)
+{
+    const char *p = str, *end = str + len, *pair;
+    PyObject *rv = NULL, *key = NULL, *val = NULL;
+
+    if (!(rv = PyDict_New())) { goto error; }
+
+    while (p < end) {
+        pair = p;
+
+        if (!(key = hstore_parse_string(&p, end, curs, unicode))) {
+            goto bad_pair;
+        }
+
+        hstore_skip_ws(&p, end);
+        if (end - p < 2 || p[0] != '=' || p[1] != '>') { goto bad_pair; }
+        p += 2;
+        hstore_skip_ws(&p, end);
+
+        if (end - p >= 4 && 0 == strncmp(p, "NULL", 4)) {
+            Py_INCREF(Py_None);
+            val = Py_None;
+            p += 4;
+        }
+        else if (!(val = hstore_parse_string(&p, end, curs, unicode))) {
+            goto bad_pair;
+        }
+
+        if (0 != PyDict_SetItem(rv, key, val)) { goto error; }
+        Py_CLEAR(key);
+        Py_CLEAR(val);
+
+        /* the pairs are separated by a comma and spaces around it */
+        if (p < end) {
+            pair = p;
+            hstore_skip_ws(&p, end);
+            if (p >= end || *p != ',') {
+                PyErr_Format(InterfaceError,
+                    "error parsing hstore: unparsed data after char %d",
+                    (int)(pair - str));
+                goto error;
+            }
+            p++;
+            hstore_skip_ws(&p, end);
+        }
+        continue;
+
+bad_pair:
+        if (!PyErr_Occurred()) {
+            PyErr_Format(InterfaceError,
+                "error parsing hstore pair at char %d", (int)(pair - str));
+        }
+        goto error;
+    }
+
+    return rv;
+
+error:
+    Py_XDECREF(key);
+    Py_XDECREF(val);
+    Py_XDECREF(rv);
+    return NULL;
+}
+
+static PyObject *
+typecast_HSTORE_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    if (str == NULL) { Py_RETURN_NONE; }
+
+    return hstore_parse(str, len, (cursorObject *)curs, 0);
+}
+
+#if PY_MAJOR_VERSION < 3
+static PyObject *
+typecast_UNICODEHSTORE_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    if (str == NULL) { Py_RETURN_NONE; }
+
+    return hstore_parse(str, len, (cursorObject *)curs, 1);
+}
+#endif
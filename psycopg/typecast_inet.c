@@ -0,0 +1,165 @@
+/* typecast_inet.c - inet and cidr typecaster
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+
+/* The inet/cidr typecaster parses the address into an int and creates the
+ * ipaddress object from an (int, prefix) tuple. Its base is the pair of the
+ * IPv4 and IPv6 classes to create, e.g. (IPv4Interface, IPv6Interface).
+ */
+
+/* Parse a dotted IPv4 address into 4 bytes; return -1 if not valid.
+ *
+ * Octets with leading zeros are not valid, as for ipaddress.
+ */
+static int
+inet_parse_v4(const char *p, const char *end, unsigned char *out)
+{
+    int i, ndigits, val;
+
+    for (i = 0; i < 4; i++) {
+        if (i) {
+            if (p >= end || *p++ != '.') { return -1; }
+        }
+        val = 0;
+        for (ndigits = 0; p < end && *p >= '0' && *p <= '9'; ndigits++) {
+            if (ndigits && !val) { return -1; }
+            val = val * 10 + (*p++ - '0');
+            if (ndigits >= 3 || val > 255) { return -1; }
+        }
+        if (!ndigits) { return -1; }
+        out[i] = (unsigned char)val;
+    }
+
+    return p == end ? 0 : -1;
+}
+
+/* Parse an IPv6 address into 16 bytes; return -1 if not valid.
+ *
+ * Accept a '::' in place of zero groups and a dotted IPv4 address as the
+ * last 32 bits.
+ */
+static int
+inet_parse_v6(const char *p, const char *end, unsigned char *out)
+{
+    const char *q;
+    int n = 0, gap = -1, val, d;
+
+    if (end - p >= 2 && p[0] == ':' && p[1] == ':') {
+        gap = 0;
+        p += 2;
+    }
+
+    while (p < end) {
+        for (q = p; q < end && *q != ':' && *q != '.'; q++) {}
+
+        if (q < end && *q == '.') {
+            if (n > 12 || 0 > inet_parse_v4(p, end, out + n)) { return -1; }
+            n += 4;
+            break;
+        }
+
+        if (q == p || q - p > 4 || n >= 16) { return -1; }
+        for (val = 0; p < q; p++) {
+            if (0 > (d = uuid_hex_digit(*p))) { return -1; }
+            val = val << 4 | d;
+        }
+        out[n++] = (unsigned char)(val >> 8);
+        out[n++] = (unsigned char)(val & 0xff);
+
+        if (p == end) { break; }
+        if (++p == end) { return -1; }  /* trailing single colon */
+        if (*p == ':') {
+            if (gap >= 0) { return -1; }
+            gap = n;
+            p++;
+        }
+    }
+
+    if (gap < 0) {
+        return n == 16 ? 0 : -1;
+    }
+    if (n == 16) { return -1; }
+
+    /* move the groups after '::' to the end and zero the gap */
+    memmove(out + 16 - (n - gap), out + gap, n - gap);
+    memset(out + gap, 0, 16 - n);
+    return 0;
+}
+
+static PyObject *
+typecast_INET_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    PyObject *classes = ((typecastObject*)((cursorObject*)curs)->caster)->bcast;
+    PyObject *cls, *num = NULL, *tmp, *rv = NULL;
+    const char *addr_end, *p, *end = str + len;
+    unsigned char bytes[16];
+    int v6, nbytes, prefix;
+
+    if (str == NULL) { Py_RETURN_NONE; }
+
+    if (!(classes && PyTuple_Check(classes) && PyTuple_GET_SIZE(classes) == 2)) {
+        PyErr_SetString(InterfaceError,
+            "the inet typecaster base must be the IPv4 and IPv6 classes");
+        return NULL;
+    }
+
+    v6 = (NULL != memchr(str, ':', len));
+    cls = PyTuple_GET_ITEM(classes, v6 ? 1 : 0);
+    nbytes = v6 ? 16 : 4;
+
+    /* the prefix is omitted if it covers the entire address */
+    if ((addr_end = memchr(str, '/', len))) {
+        prefix = 0;
+        for (p = addr_end + 1; p < end && *p >= '0' && *p <= '9'; p++) {
+            prefix = prefix * 10 + (*p - '0');
+            if (prefix > nbytes * 8) { goto fallback; }
+        }
+        if (p == addr_end + 1 || p != end) { goto fallback; }
+    }
+    else {
+        addr_end = end;
+        prefix = nbytes * 8;
+    }
+
+    if (0 > (v6 ? inet_parse_v6(str, addr_end, bytes)
+                : inet_parse_v4(str, addr_end, bytes))) {
+        goto fallback;
+    }
+
+    if (!(num = psycopg_long_from_bytes(bytes, nbytes))) { goto exit; }
+    rv = PyObject_CallFunction(cls, "((Oi))", num, prefix);
+    goto exit;
+
+fallback:
+    /* not a form we know: let the class make sense of it */
+    if ((tmp = PyUnicode_FromStringAndSize(str, len))) {
+        rv = PyObject_CallFunctionObjArgs(cls, tmp, NULL);
+        Py_DECREF(tmp);
+    }
+
+exit:
+    Py_XDECREF(num);
+    return rv;
+}
@@ -0,0 +1,581 @@
+/* typecast_json.c - json and jsonb typecasters
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+/* The json parser works on utf8 data: documents in other encodings are
+ * converted first. It accepts what json.loads() accepts with its default
+ * arguments, returning the same objects, and raises ValueError as it does.
+ *
+ * The short object keys met in a result are cached in the cursor, so that
+ * the same key in different records is the same Python object.
+ */
+
+#define JSON_KEYS_SLOTS 256     /* must be a power of 2 */
+#define JSON_KEYS_MAXLEN 32
+
+typedef struct {
+    PyObject *key;
+    Py_ssize_t len;
+    char raw[JSON_KEYS_MAXLEN];     /* the key as found in the document */
+} jsonKeySlot;
+
+struct cursJsonKeys {
+    jsonKeySlot slots[JSON_KEYS_SLOTS];
+};
+
+typedef struct {
+    const char *start;
+    const char *p;
+    const char *end;
+    cursorObject *curs;
+} jsonParser;
+
+static PyObject *json_parse_value(jsonParser *jp);
+
+
+/* Release the json keys cached for the cursor result */
+void
+typecast_json_keys_clear(cursorObject *curs)
+{
+    int i;
+
+    if (!curs->jkeys) { return; }
+
+    for (i = 0; i < JSON_KEYS_SLOTS; i++) {
+        Py_CLEAR(curs->jkeys->slots[i].key);
+    }
+    PyMem_Free(curs->jkeys);
+    curs->jkeys = NULL;
+}
+
+static PyObject *
+json_error(jsonParser *jp, const char *msg)
+{
+    PyErr_Format(PyExc_ValueError, "bad json at position %d: %s",
+        (int)(jp->p - jp->start), msg);
+    return NULL;
+}
+
+static void
+json_skip_ws(jsonParser *jp)
+{
+    while (jp->p < jp->end && (*jp->p == ' ' || *jp->p == '\t'
+            || *jp->p == '\n' || *jp->p == '\r')) {
+        jp->p++;
+    }
+}
+
+/* Return the unicode object from a chunk of utf8 */
+static PyObject *
+json_text(const char *s, Py_ssize_t len)
+{
+    if (psycopg_is_ascii(s, len)) {
+        return psycopg_unicode_from_ascii(s, len);
+    }
+#if PY_MAJOR_VERSION >= 3
+    /* lone surrogates are accepted by json.loads() */
+    return PyUnicode_DecodeUTF8(s, len, "surrogatepass");
+#else
+    return PyUnicode_DecodeUTF8(s, len, NULL);
+#endif
+}
+
+static int
+json_hex4(const char *s, unsigned int *val)
+{
+    int i;
+    unsigned int c;
+
+    *val = 0;
+    for (i = 0; i < 4; i++) {
+        c = (unsigned char)s[i];
+        if (c >= '0' && c <= '9') { c -= '0'; }
+        else if (c >= 'a' && c <= 'f') { c -= 'a' - 10; }
+        else if (c >= 'A' && c <= 'F') { c -= 'A' - 10; }
+        else { return -1; }
+        *val = (*val << 4) | c;
+    }
+    return 0;
+}
+
+/* Write the escaped string in `s` into `out` as utf8.
+ *
+ * The output is never longer than the input. Return the output length or -1
+ * on a bad escape.
+ */
+static Py_ssize_t
+json_unescape(const char *s, Py_ssize_t len, char *out)
+{
+    const char *end = s + len;
+    char *po = out;
+    unsigned int cp, lo;
+
+    while (s < end) {
+        if (*s != '\\') {
+            *po++ = *s++;
+            continue;
+        }
+        if (++s >= end) { return -1; }
+        switch (*s++) {
+        case '"': *po++ = '"'; break;
+        case '\\': *po++ = '\\'; break;
+        case '/': *po++ = '/'; break;
+        case 'b': *po++ = '\b'; break;
+        case 'f': *po++ = '\f'; break;
+        case 'n': *po++ = '\n'; break;
+        case 'r': *po++ = '\r'; break;
+        case 't': *po++ = '\t'; break;
+        case 'u':
+            if (end - s < 4 || json_hex4(s, &cp) < 0) { return -1; }
+            s += 4;
+            /* join surrogate pairs, leave lone surrogates alone */
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - s >= 6
+                    && s[0] == '\\' && s[1] == 'u'
+                    && 0 == json_hex4(s + 2, &lo)
+                    && lo >= 0xDC00 && lo <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                s += 6;
+            }
+            if (cp < 0x80) {
+                *po++ = (char)cp;
+            }
+            else if (cp < 0x800) {
+                *po++ = (char)(0xC0 | (cp >> 6));
+                *po++ = (char)(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000) {
+                *po++ = (char)(0xE0 | (cp >> 12));
+                *po++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                *po++ = (char)(0x80 | (cp & 0x3F));
+            }
+            else {
+                *po++ = (char)(0xF0 | (cp >> 18));
+                *po++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                *po++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                *po++ = (char)(0x80 | (cp & 0x3F));
+            }
+            break;
+        default:
+            return -1;
+        }
+    }
+
+    return po - out;
+}
+
+/* Scan the string starting at the current position, past the quote.
+ *
+ * Set `seg` and `len` to the string content, `escaped` if it contains
+ * backslashes, and move past the closing quote.
+ */
+static int
+json_scan_string(jsonParser *jp, const char **seg, Py_ssize_t *len,
+                 int *escaped)
+{
+    const char *p = ++jp->p;
+
+    *escaped = 0;
+    while (p < jp->end && *p != '"') {
+        if (*p == '\\') {
+            *escaped = 1;
+            p++;
+        }
+        p++;
+    }
+    if (p >= jp->end) {
+        json_error(jp, "unterminated string");
+        return -1;
+    }
+
+    *seg = jp->p;
+    *len = p - jp->p;
+    jp->p = p + 1;
+    return 0;
+}
+
+static PyObject *
+json_make_string(jsonParser *jp, const char *seg, Py_ssize_t len,
+                 int escaped)
+{
+    PyObject *rv;
+    char buffer[256];
+    char *tmp;
+
+    if (!escaped) {
+        return json_text(seg, len);
+    }
+
+    if (len <= (Py_ssize_t)sizeof(buffer)) {
+        tmp = buffer;
+    }
+    else if (!(tmp = PyMem_Malloc(len))) {
+        return PyErr_NoMemory();
+    }
+
+    if ((len = json_unescape(seg, len, tmp)) < 0) {
+        rv = json_error(jp, "bad escape in string");
+    }
+    else {
+        rv = json_text(tmp, len);
+    }
+
+    if (tmp != buffer) { PyMem_Free(tmp); }
+    return rv;
+}
+
+/* Return an object key, reusing the object if already met in the result */
+static PyObject *
+json_make_key(jsonParser *jp, const char *seg, Py_ssize_t len, int escaped)
+{
+    jsonKeySlot *slot;
+    PyObject *key;
+    unsigned int h = 2166136261u;
+    Py_ssize_t i;
+
+    if (len > JSON_KEYS_MAXLEN) {
+        return json_make_string(jp, seg, len, escaped);
+    }
+
+    if (!jp->curs->jkeys) {
+        if (!(jp->curs->jkeys = PyMem_Malloc(sizeof(struct cursJsonKeys)))) {
+            return PyErr_NoMemory();
+        }
+        memset(jp->curs->jkeys, 0, sizeof(struct cursJsonKeys));
+    }
+
+    for (i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)seg[i]) * 16777619u;
+    }
+    slot = &jp->curs->jkeys->slots[h & (JSON_KEYS_SLOTS - 1)];
+
+    if (slot->key && slot->len == len && 0 == memcmp(slot->raw, seg, len)) {
+        Py_INCREF(slot->key);
+        return slot->key;
+    }
+
+    if (!(key = json_make_string(jp, seg, len, escaped))) {
+        return NULL;
+    }
+    Py_XDECREF(slot->key);
+    Py_INCREF(key);
+    slot->key = key;
+    slot->len = len;
+    memcpy(slot->raw, seg, len);
+
+    return key;
+}
+
+static PyObject *
+json_parse_number(jsonParser *jp)
+{
+    const char *s = jp->p, *p = jp->p;
+    int isfloat = 0;
+    PY_LONG_LONG val = 0;
+    PyObject *rv;
+    Py_ssize_t len;
+    char buffer[64];
+    char *tmp;
+
+    if (p < jp->end && *p == '-') { p++; }
+    if (p >= jp->end || *p < '0' || *p > '9') {
+        return json_error(jp, "unexpected character");
+    }
+    while (p < jp->end && *p >= '0' && *p <= '9') { p++; }
+    if (p < jp->end && *p == '.') {
+        isfloat = 1;
+        if (++p >= jp->end || *p < '0' || *p > '9') {
+            jp->p = p;
+            return json_error(jp, "bad number");
+        }
+        while (p < jp->end && *p >= '0' && *p <= '9') { p++; }
+    }
+    if (p < jp->end && (*p == 'e' || *p == 'E')) {
+        isfloat = 1;
+        p++;
+        if (p < jp->end && (*p == '+' || *p == '-')) { p++; }
+        if (p >= jp->end || *p < '0' || *p > '9') {
+            jp->p = p;
+            return json_error(jp, "bad number");
+        }
+        while (p < jp->end && *p >= '0' && *p <= '9') { p++; }
+    }
+    jp->p = p;
+    len = p - s;
+
+    /* up to 18 digits fit a long long */
+    if (!isfloat && len <= 18) {
+        typecast_parse_int(s, len, &val);
+#if PY_MAJOR_VERSION < 3
+        if (val >= LONG_MIN && val <= LONG_MAX) {
+            return PyInt_FromLong((long)val);
+        }
+#endif
+        return PyLong_FromLongLong(val);
+    }
+
+    if (len < (Py_ssize_t)sizeof(buffer)) {
+        tmp = buffer;
+    }
+    else if (!(tmp = PyMem_Malloc(len + 1))) {
+        return PyErr_NoMemory();
+    }
+    memcpy(tmp, s, len);
+    tmp[len] = '\0';
+
+    if (isfloat) {
+        double d = PyOS_string_to_double(tmp, NULL, NULL);
+        rv = (d == -1.0 && PyErr_Occurred()) ? NULL : PyFloat_FromDouble(d);
+    }
+    else {
+#if PY_MAJOR_VERSION < 3
+        rv = PyInt_FromString(tmp, NULL, 10);
+#else
+        rv = PyLong_FromString(tmp, NULL, 10);
+#endif
+    }
+
+    if (tmp != buffer) { PyMem_Free(tmp); }
+    return rv;
+}
+
+/* Return 1 and move past `word` if it is at the current position */
+static int
+json_match(jsonParser *jp, const char *word, Py_ssize_t len)
+{
+    if (jp->end - jp->p >= len && 0 == memcmp(jp->p, word, len)) {
+        jp->p += len;
+        return 1;
+    }
+    return 0;
+}
+
+static PyObject *
+json_parse_array(jsonParser *jp)
+{
+    PyObject *rv = NULL, *item;
+
+    if (!(rv = PyList_New(0))) { return NULL; }
+
+    jp->p++;
+    json_skip_ws(jp);
+    if (jp->p < jp->end && *jp->p == ']') {
+        jp->p++;
+        return rv;
+    }
+
+    for (;;) {
+        if (!(item = json_parse_value(jp))) { goto error; }
+        if (0 > PyList_Append(rv, item)) {
+            Py_DECREF(item);
+            goto error;
+        }
+        Py_DECREF(item);
+
+        json_skip_ws(jp);
+        if (jp->p < jp->end && *jp->p == ',') {
+            jp->p++;
+            continue;
+        }
+        if (jp->p < jp->end && *jp->p == ']') {
+            jp->p++;
+            return rv;
+        }
+        json_error(jp, "expected ',' or ']'");
+        goto error;
+    }
+
+error:
+    Py_DECREF(rv);
+    return NULL;
+}
+
+static PyObject *
+json_parse_object(jsonParser *jp)
+{
+    PyObject *rv = NULL, *key = NULL, *val = NULL;
+    const char *seg;
+    Py_ssize_t len;
+    int escaped;
+
+    if (!(rv = PyDict_New())) { return NULL; }
+
+    jp->p++;
+    json_skip_ws(jp);
+    if (jp->p < jp->end && *jp->p == '}') {
+        jp->p++;
+        return rv;
+    }
+
+    for (;;) {
+        json_skip_ws(jp);
+        if (jp->p >= jp->end || *jp->p != '"') {
+            json_error(jp, "expected string key");
+            goto error;
+        }
+        if (0 > json_scan_string(jp, &seg, &len, &escaped)) { goto error; }
+        if (!(key = json_make_key(jp, seg, len, escaped))) { goto error; }
+
+        json_skip_ws(jp);
+        if (jp->p >= jp->end || *jp->p != ':') {
+            json_error(jp, "expected ':'");
+            goto error;
+        }
+        jp->p++;
+
+        if (!(val = json_parse_value(jp))) { goto error; }
+        if (0 > PyDict_SetItem(rv, key, val)) { goto error; }
+        Py_CLEAR(key);
+        Py_CLEAR(val);
+
+        json_skip_ws(jp);
+        if (jp->p < jp->end && *jp->p == ',') {
+            jp->p++;
+            continue;
+        }
+        if (jp->p < jp->end && *jp->p == '}') {
+            jp->p++;
+            return rv;
+        }
+        json_error(jp, "expected ',' or '}'");
+        goto error;
+    }
+
+error:
+    Py_XDECREF(key);
+    Py_XDECREF(val);
+    Py_DECREF(rv);
+    return NULL;
+}
+
+static PyObject *
+json_parse_value(jsonParser *jp)
+{
+    PyObject *rv;
+    const char *seg;
+    Py_ssize_t len;
+    int escaped;
+
+    json_skip_ws(jp);
+    if (jp->p >= jp->end) {
+        return json_error(jp, "expected value");
+    }
+
+    switch (*jp->p) {
+    case '{':
+    case '[':
+        if (Py_EnterRecursiveCall(" while decoding a json document")) {
+            return NULL;
+        }
+        rv = (*jp->p == '{') ? json_parse_object(jp) : json_parse_array(jp);
+        Py_LeaveRecursiveCall();
+        return rv;
+
+    case '"':
+        if (0 > json_scan_string(jp, &seg, &len, &escaped)) { return NULL; }
+        return json_make_string(jp, seg, len, escaped);
+
+    case 't':
+        if (json_match(jp, "true", 4)) { Py_RETURN_TRUE; }
+        break;
+
+    case 'f':
+        if (json_match(jp, "false", 5)) { Py_RETURN_FALSE; }
+        break;
+
+    case 'n':
+        if (json_match(jp, "null", 4)) { Py_RETURN_NONE; }
+        break;
+
+    case 'N':
+        if (json_match(jp, "NaN", 3)) { return PyFloat_FromDouble(Py_NAN); }
+        break;
+
+    case 'I':
+        if (json_match(jp, "Infinity", 8)) {
+            return PyFloat_FromDouble(Py_HUGE_VAL);
+        }
+        break;
+
+    case '-':
+        if (json_match(jp, "-Infinity", 9)) {
+            return PyFloat_FromDouble(-Py_HUGE_VAL);
+        }
+        return json_parse_number(jp);
+
+    default:
+        return json_parse_number(jp);
+    }
+
+    return json_error(jp, "unexpected character");
+}
+
+/* Parse the utf8 json document in `s` */
+static PyObject *
+json_parse(const char *s, Py_ssize_t len, cursorObject *curs)
+{
+    jsonParser jp;
+    PyObject *rv;
+
+    jp.start = jp.p = s;
+    jp.end = s + len;
+    jp.curs = curs;
+
+    if (!(rv = json_parse_value(&jp))) { return NULL; }
+
+    json_skip_ws(&jp);
+    if (jp.p < jp.end) {
+        Py_DECREF(rv);
+        return json_error(&jp, "extra data");
+    }
+
+    return rv;
+}
+
+/** JSON - parse json and jsonb into Python objects **/
+
+static PyObject *
+typecast_JSON_cast(const char *s, Py_ssize_t len, PyObject *curs)
+{
+    connectionObject *conn;
+    PyObject *str = NULL, *b = NULL, *rv = NULL;
+
+    if (s == NULL) { Py_RETURN_NONE; }
+
+    conn = ((cursorObject *)curs)->conn;
+    if (!conn || conn->cdecoder == PyUnicode_DecodeUTF8
+            || psycopg_is_ascii(s, len)) {
+        return json_parse(s, len, (cursorObject *)curs);
+    }
+
+    /* not utf8: convert the document first */
+    if (!(str = conn_decode(conn, s, len))) { goto exit; }
+    if (!(b = PyUnicode_AsUTF8String(str))) { goto exit; }
+    rv = json_parse(
+        Bytes_AS_STRING(b), Bytes_GET_SIZE(b), (cursorObject *)curs);
+
+exit:
+    Py_XDECREF(b);
+    Py_XDECREF(str);
+    return rv;
+}
@@ -0,0 +1,162 @@
+/* typecast_range.c - range types typecaster
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+/* The range typecaster is created by RangeCaster, which is stored as the base
+ * of the typecaster. The bounds are cast by the typecaster of its
+ * `subtype_oid` and the result is an instance of its `range` class.
+ */
+
+/* Scan a bound at *pp, up to one of the `stop` chars or past a quoted string.
+ *
+ * The bound is copied into `buf`, unescaped if quoted. An empty bound returns
+ * a NULL token. Return -1 if a quoted bound is not terminated.
+ */
+static int
+range_scan_bound(const char **pp, const char *end, char stop1, char stop2,
+                 char *buf, const char **token, Py_ssize_t *len)
+{
+    const char *p = *pp;
+    char *po;
+
+    if (p < end && *p == '"') {
+        po = buf;
+        for (p++; ; p++) {
+            if (p >= end) { return -1; }
+            if (*p == '"') {
+                if (p + 1 < end && p[1] == '"') { p++; }
+                else { break; }
+            }
+            else if (*p == '\\') {
+                if (++p >= end) { return -1; }
+            }
+            *po++ = *p;
+        }
+        *po = '\0';
+        *pp = p + 1;
+        *token = buf;
+        *len = po - buf;
+        return 0;
+    }
+
+    /* copy the bound too: the typecasters may expect a terminated string */
+    while (p < end && *p != stop1 && *p != stop2 && *p != '"') { p++; }
+    *len = p - *pp;
+    if (*len) {
+        memcpy(buf, *pp, *len);
+        buf[*len] = '\0';
+        *token = buf;
+    }
+    else {
+        *token = NULL;
+    }
+    *pp = p;
+    return 0;
+}
+
+static PyObject *
+typecast_RANGE_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    PyObject *caster = ((typecastObject*)((cursorObject*)curs)->caster)->bcast;
+    PyObject *range = NULL, *oid = NULL, *cast;
+    PyObject *lower = NULL, *upper = NULL, *bounds = NULL, *rv = NULL;
+    PyObject *args = NULL, *kwargs = NULL, *tmp;
+    PyObject *cargs[3];
+    const char *p, *end, *token;
+    Py_ssize_t tlen;
+    char *buf = NULL;
+    char b[2];
+
+    if (str == NULL) { Py_RETURN_NONE; }
+
+    if (!caster) {
+        PyErr_SetString(InterfaceError,
+            "the range typecaster must be created by RangeCaster");
+        goto exit;
+    }
+
+    if (!(range = PyObject_GetAttrString(caster, "range"))) { goto exit; }
+
+    if (len == 5 && 0 == strncmp(str, "empty", 5)) {
+        if (!(args = PyTuple_New(0))) { goto exit; }
+        if (!(kwargs = Py_BuildValue("{s:O}", "empty", Py_True))) {
+            goto exit;
+        }
+        rv = PyObject_Call(range, args, kwargs);
+        goto exit;
+    }
+
+    p = str;
+    end = str + len;
+    if (p >= end || (*p != '[' && *p != '(')) { goto bad; }
+    b[0] = *p++;
+
+    /* the bounds are never longer than the literal */
+    if (!(buf = PyMem_Malloc(len + 1))) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    if (!(oid = PyObject_GetAttrString(caster, "subtype_oid"))) { goto exit; }
+    cast = curs_get_cast((cursorObject *)curs, oid);
+
+    if (0 > range_scan_bound(&p, end, ',', ',', buf, &token, &tlen)) {
+        goto bad;
+    }
+    if (p >= end || *p != ',') { goto bad; }
+    p++;
+    if (!(lower = typecast_cast(cast, token, tlen, curs))) { goto exit; }
+
+    if (0 > range_scan_bound(&p, end, ')', ']', buf, &token, &tlen)) {
+        goto bad;
+    }
+    if (p + 1 != end || (*p != ')' && *p != ']')) { goto bad; }
+    b[1] = *p;
+    if (!(upper = typecast_cast(cast, token, tlen, curs))) { goto exit; }
+
+    if (!(bounds = Text_FromUTF8AndSize(b, 2))) { goto exit; }
+    cargs[0] = lower;
+    cargs[1] = upper;
+    cargs[2] = bounds;
+    rv = psyco_Vectorcall(range, cargs, 3, NULL);
+    goto exit;
+
+bad:
+    if ((tmp = Bytes_FromStringAndSize(str, len))) {
+        PyErr_Format(InterfaceError, "failed to parse range: '%s'",
+            Bytes_AS_STRING(tmp));
+        Py_DECREF(tmp);
+    }
+
+exit:
+    PyMem_Free(buf);
+    Py_XDECREF(args);
+    Py_XDECREF(kwargs);
+    Py_XDECREF(bounds);
+    Py_XDECREF(upper);
+    Py_XDECREF(lower);
+    Py_XDECREF(oid);
+    Py_XDECREF(range);
+    return rv;
+}
@@ -0,0 +1,115 @@
+/* typecast_uuid.c - uuid typecaster
+ *
+ * Copyright (C) 2019  Daniele Varrazzo <daniele.varrazzo@gmail.com>
+ *
+ * This file is part of psycopg.
+ *
+ * psycopg2 is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link this program with the OpenSSL library (or with
+ * modified versions of OpenSSL that use the same license as OpenSSL),
+ * and distribute linked combinations including the two.
+ *
+ * You must obey the GNU Lesser General Public License in all respects for
+ * all of the code used other than OpenSSL.
+ *
+ * psycopg2 is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ */
+
+
+/* The uuid typecaster builds the uuid.UUID objects setting their 128 bits
+ * int, without going through the constructor and its string parsing.
+ */
+
+static int
+uuid_hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') { return c - '0'; }
+    if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+    if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+    return -1;
+}
+
+/* Parse the canonical form xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx into 16 bytes.
+ *
+ * Return -1 if the string is in a different form.
+ */
+static int
+uuid_parse(const char *str, Py_ssize_t len, unsigned char *out)
+{
+    Py_ssize_t i;
+    int hi, lo;
+
+    if (len != 36) { return -1; }
+
+    /* the groups have an even number of digits: no pair spans a dash */
+    for (i = 0; i < 36;) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            if (str[i++] != '-') { return -1; }
+            continue;
+        }
+        if (0 > (hi = uuid_hex_digit(str[i++]))) { return -1; }
+        if (0 > (lo = uuid_hex_digit(str[i++]))) { return -1; }
+        *out++ = (unsigned char)(hi << 4 | lo);
+    }
+    return 0;
+}
+
+static PyObject *
+typecast_UUID_cast(const char *str, Py_ssize_t len, PyObject *curs)
+{
+    static PyObject *s_int = NULL, *s_is_safe = NULL;
+    PyObject *uuidType = NULL, *safe = NULL;
+    PyObject *args = NULL, *val = NULL, *tmp, *rv = NULL;
+    unsigned char bytes[16];
+
+    if (str == NULL || len == 0) { Py_RETURN_NONE; }
+
+    if (!(uuidType = psyco_GetUUIDType(&safe))) { goto exit; }
+
+    /* not a form we know: let the class make sense of it */
+    if (0 > uuid_parse(str, len, bytes)) {
+        if ((tmp = Text_FromUTF8AndSize(str, len))) {
+            rv = PyObject_CallFunctionObjArgs(uuidType, tmp, NULL);
+            Py_DECREF(tmp);
+        }
+        goto exit;
+    }
+
+    if (!s_int) {
+        if (!(s_int = Text_FromUTF8("int"))) { goto exit; }
+    }
+    if (!s_is_safe) {
+        if (!(s_is_safe = Text_FromUTF8("is_safe"))) { goto exit; }
+    }
+
+    /* UUID only allows to set its attributes through object.__setattr__ */
+    if (!(args = PyTuple_New(0))) { goto exit; }
+    if (!(rv = ((PyTypeObject *)uuidType)->tp_new(
+            (PyTypeObject *)uuidType, args, NULL))) {
+        goto exit;
+    }
+    if (!(val = psycopg_long_from_bytes(bytes, 16))) { goto error; }
+    if (0 > PyObject_GenericSetAttr(rv, s_int, val)) { goto error; }
+    if (safe != Py_None) {
+        if (0 > PyObject_GenericSetAttr(rv, s_is_safe, safe)) { goto error; }
+    }
+    goto exit;
+
+error:
+    Py_CLEAR(rv);
+
+exit:
+    Py_XDECREF(val);
+    Py_XDECREF(args);
+    Py_XDECREF(safe);
+    Py_XDECREF(uuidType);
+    return rv;
+}
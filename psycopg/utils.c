@@ -280,6 +280,138 @@ exit:
 }
 
 
+/* Return 1 if the first `len` bytes of `str` are all ASCII, else 0.
+ *
+ * Check 16 bytes at time using SSE2 where available, then a word at time.
+ */
+int
+psycopg_is_ascii(const char *str, Py_ssize_t len)
+{
+    const unsigned char *p = (const unsigned char *)str;
+    const unsigned char *end = p + len;
+    const size_t mask = ((size_t)-1 / 0xFF) * 0x80;
+    size_t word;
+
+#ifdef PSYCOPG_HAVE_SSE2
+    while (end - p >= 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p))) {
+            return 0;
+        }
+        p += 16;
+    }
+#endif
+
+    while (end - p >= (Py_ssize_t)sizeof(size_t)) {
+        memcpy(&word, p, sizeof(size_t));
+        if (word & mask) { return 0; }
+        p += sizeof(size_t);
+    }
+
+    while (p < end) {
+        if (*p++ & 0x80) { return 0; }
+    }
+
+    return 1;
+}
+
+
+/* Return a new unicode object from a string known to be pure ASCII.
+ *
+ * On Python 3 build the compact object directly, skipping the codec.
+ */
+PyObject *
+psycopg_unicode_from_ascii(const char *str, Py_ssize_t len)
+{
+#if PY_MAJOR_VERSION < 3
+    return PyUnicode_DecodeASCII(str, len, NULL);
+#else
+    PyObject *rv;
+
+    if (!(rv = PyUnicode_New(len, 127))) { return NULL; }
+    memcpy(PyUnicode_1BYTE_DATA(rv), str, len);
+    return rv;
+#endif
+}
+
+
+/* Return a new int from `n` (up to 16) unsigned big-endian bytes.
+ *
+ * The public API has no function for it: build it from two 64 bits halves.
+ */
+PyObject *
+psycopg_long_from_bytes(const unsigned char *bytes, int n)
+{
+    unsigned PY_LONG_LONG hi = 0, lo = 0;
+    PyObject *phi = NULL, *plo = NULL, *shift = NULL, *tmp = NULL;
+    PyObject *rv = NULL;
+    int i;
+
+    for (i = 0; i < n - 8; i++) { hi = hi << 8 | bytes[i]; }
+    for (i = n > 8 ? n - 8 : 0; i < n; i++) { lo = lo << 8 | bytes[i]; }
+
+    if (!hi) { return PyLong_FromUnsignedLongLong(lo); }
+
+    if (!(phi = PyLong_FromUnsignedLongLong(hi))) { goto exit; }
+    if (!(plo = PyLong_FromUnsignedLongLong(lo))) { goto exit; }
+    if (!(shift = PyLong_FromLong(64))) { goto exit; }
+    if (!(tmp = PyNumber_Lshift(phi, shift))) { goto exit; }
+    rv = PyNumber_Or(tmp, plo);
+
+exit:
+    Py_XDECREF(tmp);
+    Py_XDECREF(shift);
+    Py_XDECREF(plo);
+    Py_XDECREF(phi);
+    return rv;
+}
+
+
+/* Write the int `num` into `n` (up to 16) unsigned big-endian bytes.
+ *
+ * Return -1 and raise OverflowError if the number is negative or too big.
+ */
+RAISES_NEG int
+psycopg_long_as_bytes(PyObject *num, unsigned char *bytes, int n)
+{
+    unsigned PY_LONG_LONG hi = 0, lo;
+    PyObject *shift = NULL, *phi = NULL;
+    int i, rv = -1;
+
+    if (n > 8) {
+        if (!(shift = PyLong_FromLong(64))) { goto exit; }
+        if (!(phi = PyNumber_Rshift(num, shift))) { goto exit; }
+        hi = PyLong_AsUnsignedLongLong(phi);
+        if (hi == (unsigned PY_LONG_LONG)-1 && PyErr_Occurred()) { goto exit; }
+        lo = PyLong_AsUnsignedLongLongMask(num);
+        if (n < 16 && hi >> (8 * (n - 8))) { goto overflow; }
+    }
+    else {
+        lo = PyLong_AsUnsignedLongLong(num);
+        if (lo == (unsigned PY_LONG_LONG)-1 && PyErr_Occurred()) { goto exit; }
+        if (n < 8 && lo >> (8 * n)) { goto overflow; }
+    }
+
+    for (i = n - 1; i >= 0 && i >= n - 8; i--) {
+        bytes[i] = (unsigned char)lo;
+        lo >>= 8;
+    }
+    for (; i >= 0; i--) {
+        bytes[i] = (unsigned char)hi;
+        hi >>= 8;
+    }
+    rv = 0;
+    goto exit;
+
+overflow:
+    PyErr_SetString(PyExc_OverflowError, "int too big to convert");
+
+exit:
+    Py_XDECREF(phi);
+    Py_XDECREF(shift);
+    return rv;
+}
+
+
 /* Make a connection string out of a string and a dictionary of arguments.
  *
  * Helper to call psycopg2.extensions.make_dsn()
@@ -333,6 +465,11 @@ psycopg_text_from_chars_safe(const char *str, Py_ssize_t len, PyObject *decoder)
 
     if (len < 0) { len = strlen(str); }
 
+    /* pure ASCII is the same in every encoding PostgreSQL can use */
+    if (psycopg_is_ascii(str, len)) {
+        return psycopg_unicode_from_ascii(str, len);
+    }
+
     if (decoder) {
         if (!replace) {
             if (!(replace = PyUnicode_FromString("replace"))) { goto exit; }
@@ -356,3 +493,143 @@ exit:
 
 #endif
 }
+
+
+/* Parse the arguments of a method declared as PSYCO_METH_KEYWORDS.
+ *
+ * Only object arguments are supported: 'kwlist' contains their names, and
+ * the first 'nrequired' are mandatory. The varargs are the 'PyObject **'
+ * receiving borrowed references: the required ones must be initialized to
+ * NULL, the optional ones are left untouched if not passed.
+ */
+#define PARSE_ARGS_MAX 8
+
+RAISES_NEG int
+psyco_parse_args(PSYCO_ARGS, const char *fname, char **kwlist,
+    int nrequired, ...)
+{
+    int nparams, i;
+    va_list va;
+
+    for (nparams = 0; kwlist[nparams]; nparams++) {}
+    if (nparams > PARSE_ARGS_MAX) {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+
+#if PY_VERSION_HEX >= 0x03070000
+    {
+        PyObject **out[PARSE_ARGS_MAX];
+        Py_ssize_t nkw = kwnames ? PyTuple_GET_SIZE(kwnames) : 0, j;
+        PyObject *key;
+
+        va_start(va, nrequired);
+        for (i = 0; i < nparams; i++) {
+            out[i] = va_arg(va, PyObject **);
+        }
+        va_end(va);
+
+        if (nargs + nkw > nparams) {
+            PyErr_Format(PyExc_TypeError,
+                "%s() takes at most %d arguments (%d given)",
+                fname, nparams, (int)(nargs + nkw));
+            return -1;
+        }
+
+        for (i = 0; i < nargs; i++) {
+            *out[i] = args[i];
+        }
+
+        for (j = 0; j < nkw; j++) {
+            key = PyTuple_GET_ITEM(kwnames, j);
+            for (i = 0; i < nparams; i++) {
+                if (0 == PyUnicode_CompareWithASCIIString(key, kwlist[i])) {
+                    break;
+                }
+            }
+            if (i == nparams) {
+                PyErr_Format(PyExc_TypeError,
+                    "'%U' is an invalid keyword argument for %s()",
+                    key, fname);
+                return -1;
+            }
+            if (i < nargs) {
+                PyErr_Format(PyExc_TypeError,
+                    "argument for %s() given by name ('%s') and position (%d)",
+                    fname, kwlist[i], i + 1);
+                return -1;
+            }
+            *out[i] = args[nargs + j];
+        }
+
+        for (i = 0; i < nrequired; i++) {
+            if (!*out[i]) {
+                PyErr_Format(PyExc_TypeError,
+                    "%s() missing required argument '%s' (pos %d)",
+                    fname, kwlist[i], i + 1);
+                return -1;
+            }
+        }
+    }
+    return 0;
+#else
+    {
+        char fmt[PARSE_ARGS_MAX + 2];
+        char *f = fmt;
+        int rv;
+
+        for (i = 0; i < nparams; i++) {
+            if (i == nrequired) { *f++ = '|'; }
+            *f++ = 'O';
+        }
+        *f = '\0';
+
+        va_start(va, nrequired);
+        rv = PyArg_VaParseTupleAndKeywords(args, kwargs, fmt, kwlist, va);
+        va_end(va);
+        return rv ? 0 : -1;
+    }
+#endif
+}
+
+
+#if PY_VERSION_HEX < 0x03080000
+/* Emulate PyObject_Vectorcall() on the Python versions missing it.
+ *
+ * 'kwnames' is an optional tuple with the names of the last arguments in
+ * 'args', to be passed as keywords.
+ */
+PyObject *
+psyco_Vectorcall(PyObject *callable, PyObject *const *args,
+    size_t nargsf, PyObject *kwnames)
+{
+    Py_ssize_t nargs = (Py_ssize_t)(nargsf & ~PY_VECTORCALL_ARGUMENTS_OFFSET);
+    Py_ssize_t nkw = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    PyObject *pargs = NULL, *kwargs = NULL;
+    PyObject *rv = NULL;
+    Py_ssize_t i;
+
+    if (!(pargs = PyTuple_New(nargs))) { goto exit; }
+    for (i = 0; i < nargs; i++) {
+        Py_INCREF(args[i]);
+        PyTuple_SET_ITEM(pargs, i, args[i]);
+    }
+
+    if (nkw) {
+        if (!(kwargs = PyDict_New())) { goto exit; }
+        for (i = 0; i < nkw; i++) {
+            if (0 != PyDict_SetItem(kwargs,
+                    PyTuple_GET_ITEM(kwnames, i), args[nargs + i])) {
+                goto exit;
+            }
+        }
+    }
+
+    rv = PyObject_Call(callable, pargs, kwargs);
+
+exit:
+    Py_XDECREF(pargs);
+    Py_XDECREF(kwargs);
+    return rv;
+}
+#endif
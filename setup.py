@@ -492,11 +492,13 @@ sources = [
     'replication_message_type.c',
     'diagnostics_type.c', 'error_type.c', 'conninfo_type.c',
     'lobject_int.c', 'lobject_type.c',
-    'notify_type.c', 'xid_type.c',
+    'notify_type.c', 'xid_type.c', 'query_template.c', 'sql_compose.c',
 
     'adapter_asis.c', 'adapter_binary.c', 'adapter_datetime.c',
-    'adapter_list.c', 'adapter_pboolean.c', 'adapter_pdecimal.c',
-    'adapter_pint.c', 'adapter_pfloat.c', 'adapter_qstring.c',
+    'adapter_hstore.c', 'adapter_inet.c', 'adapter_list.c',
+    'adapter_pboolean.c', 'adapter_pdecimal.c', 'adapter_pint.c',
+    'adapter_pfloat.c', 'adapter_qstring.c', 'adapter_range.c',
+    'adapter_sqlin.c', 'adapter_uuid.c',
     'microprotocols.c', 'microprotocols_proto.c',
     'typecast.c',
 ]
@@ -509,17 +511,22 @@ depends = [
     'replication_cursor.h',
     'replication_message.h',
     'notify.h', 'pqpath.h', 'xid.h', 'column.h', 'conninfo.h',
+    'query_template.h', 'sql_compose.h',
     'libpq_support.h', 'win32_support.h',
 
     'adapter_asis.h', 'adapter_binary.h', 'adapter_datetime.h',
-    'adapter_list.h', 'adapter_pboolean.h', 'adapter_pdecimal.h',
-    'adapter_pint.h', 'adapter_pfloat.h', 'adapter_qstring.h',
+    'adapter_hstore.h', 'adapter_inet.h', 'adapter_list.h',
+    'adapter_pboolean.h', 'adapter_pdecimal.h', 'adapter_pint.h',
+    'adapter_pfloat.h', 'adapter_qstring.h', 'adapter_range.h',
+    'adapter_sqlin.h', 'adapter_uuid.h',
     'microprotocols.h', 'microprotocols_proto.h',
     'typecast.h', 'typecast_binary.h',
 
     # included sources
     'typecast_array.c', 'typecast_basic.c', 'typecast_binary.c',
-    'typecast_builtins.c', 'typecast_datetime.c',
+    'typecast_builtins.c', 'typecast_composite.c', 'typecast_datetime.c',
+    'typecast_hstore.c', 'typecast_inet.c', 'typecast_json.c',
+    'typecast_range.c', 'typecast_uuid.c',
 ]
 
 parser = configparser.ConfigParser()
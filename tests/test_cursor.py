@@ -136,6 +136,37 @@ class CursorTests(ConnectingTestCase):
         self.assertRaises(psycopg2.ProgrammingError,
             cur.mogrify, "select %(foo, %(bar)", {'foo': 1, 'bar': 2})
 
+    def test_mogrify_cached_query(self):
+        cur = self.conn.cursor()
+        for i in range(3):
+            self.assertEqual(
+                cur.mogrify("select %s, '%%', %s", (i, None)),
+                b"select " + str(i).encode() + b", '%', NULL")
+            self.assertEqual(
+                cur.mogrify("select %(a)s, %(b)s, %(a)s", {'a': i, 'b': 'x'}),
+                b"select " + str(i).encode() + b", 'x', "
+                + str(i).encode())
+
+        self.assertRaises(psycopg2.ProgrammingError,
+            cur.mogrify, "select %s, %(a)s", (1, 2))
+        self.assertRaises(TypeError,
+            cur.mogrify, "select %s", (1, 2))
+        self.assertRaises(IndexError,
+            cur.mogrify, "select %s, %s", (1,))
+        self.assertRaises(KeyError,
+            cur.mogrify, "select %(a)s, %(b)s", {'a': 1})
+
+    def test_mogrify_many_queries(self):
+        cur = self.conn.cursor()
+        for i in range(2000):
+            self.assertEqual(
+                cur.mogrify("select %s, " + str(i), (i,)),
+                ("select %d, %d" % (i, i)).encode())
+        for i in range(2000):
+            self.assertEqual(
+                cur.mogrify("select %s, " + str(i), (i,)),
+                ("select %d, %d" % (i, i)).encode())
+
     def test_cast(self):
         curs = self.conn.cursor()
 
@@ -650,6 +681,62 @@ class CursorTests(ConnectingTestCase):
             [(i,) for i in range(5)])
         self.assertEqual(cur.rowcount, 5)
 
+    def test_intern_values(self):
+        cur = self.conn.cursor()
+        self.assertEqual(cur.intern_values, False)
+        cur.intern_values = True
+        cur.execute("""
+            select 'status' || (x %% 3), (x %% 2)::int8, array[x %% 2],
+                '2020-01-01'::date, null::text
+            from generate_series(1, 10) x""")
+        recs = cur.fetchall()
+        self.assertEqual(recs[0][0], 'status1')
+        self.assertEqual(recs[1][:2], ('status2', 0))
+        self.assert_(recs[0][0] is recs[3][0])
+        self.assert_(recs[0][1] is recs[2][1])
+        self.assert_(recs[0][3] is recs[9][3])
+        self.assertEqual(recs[0][4], None)
+
+        # mutable objects are never shared
+        self.assertEqual(recs[0][2], [1])
+        self.assert_(recs[0][2] is not recs[2][2])
+
+        cur.intern_values = False
+        cur.execute("select 'status' || (x %% 2) from generate_series(1, 4) x")
+        recs = cur.fetchall()
+        self.assertEqual(recs[0][0], recs[2][0])
+        self.assert_(recs[0][0] is not recs[2][0])
+
+    def test_intern_values_low_hit_rate(self):
+        cur = self.conn.cursor()
+        cur.intern_values = True
+        cur.execute("select x::text, 'a' from generate_series(1, 5000) x")
+        recs = cur.fetchall()
+        self.assertEqual([r[0] for r in recs],
+            [str(i) for i in range(1, 5001)])
+        self.assert_(recs[0][1] is recs[-1][1])
+
+    def test_fetch_many_rows(self):
+        # big fetches parse the values in batches with the GIL released:
+        # the results must be the same of the fetch of one row at time
+        query = """
+            select x, x::int8 << 40, x %% 2 = 0, '2020-01-01'::date + x,
+                '2020-01-01 00:00:00.5+02'::timestamptz + x * '1m'::interval,
+                '10:00'::time + x * '1s'::interval, x::text,
+                case when x %% 3 = 0 then x end
+            from generate_series(1, 2000) x"""
+        cur = self.conn.cursor()
+        cur.execute(query)
+        expected = [cur.fetchone() for i in range(2000)]
+
+        cur.execute(query)
+        self.assertEqual(cur.fetchall(), expected)
+
+        cur.execute(query)
+        self.assertEqual(cur.fetchone(), expected[0])
+        self.assertEqual(cur.fetchmany(1500), expected[1:1501])
+        self.assertEqual(cur.fetchall(), expected[1501:])
+
 
 def test_suite():
     return unittest.TestLoader().loadTestsFromName(__name__)
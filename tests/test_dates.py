@@ -26,7 +26,8 @@ import math
 import psycopg2
 from psycopg2.tz import FixedOffsetTimezone, ZERO
 import unittest
-from .testutils import ConnectingTestCase, skip_before_postgres
+from .testutils import (
+    ConnectingTestCase, skip_before_postgres, skip_before_python)
 
 
 def total_seconds(d):
@@ -206,6 +207,30 @@ class DatetimeTests(ConnectingTestCase, CommonDatetimeTestsMixin):
         self.assertEqual(
             self.DATETIME("2007-01-01 13:30:29.123456", self.curs).tzinfo, None)
 
+    def test_parse_datetime_fraction_digits(self):
+        for frac, us in [('1', 100000), ('12', 120000), ('0001', 100),
+                         ('123456', 123456), ('000001', 1)]:
+            value = self.DATETIME('2007-01-01 13:30:29.%s' % frac, self.curs)
+            self.assertEqual(value.microsecond, us)
+            value = self.DATETIME(
+                '2007-01-01 13:30:29.%s+02' % frac, self.curs)
+            self.assertEqual(value.microsecond, us)
+            value = self.TIME('13:30:29.%s' % frac, self.curs)
+            self.assertEqual(value.microsecond, us)
+
+    def test_parse_datetime_layouts(self):
+        from datetime import date, datetime
+        self.assertEqual(self.DATE('2007-01-31', self.curs), date(2007, 1, 31))
+        self.assertEqual(self.DATETIME('2007-01-31T13:30:29', self.curs),
+            datetime(2007, 1, 31, 13, 30, 29))
+        self.assertEqual(self.DATETIME('2007-01-31 13:30:60', self.curs),
+            datetime(2007, 1, 31, 13, 31, 0))
+        self.assertEqual(self.DATETIME('12007-01-31 13:30:29', self.curs),
+            datetime(9999, 1, 31, 13, 30, 29))
+        self.assertRaises(ValueError, self.DATE, '2007-02-30', self.curs)
+        self.assertRaises(ValueError,
+            self.DATETIME, '2007-13-01 13:30:29', self.curs)
+
     def test_parse_interval(self):
         value = self.INTERVAL('42 days 12:34:56.123456', self.curs)
         self.assertNotEqual(value, None)
@@ -292,6 +317,37 @@ class DatetimeTests(ConnectingTestCase, CommonDatetimeTestsMixin):
         self.assertNotEqual(None, dt2.tzinfo)
         self.assertEqual(dt1, dt2)
 
+    def test_tzinfo_factory_calls(self):
+        from datetime import timedelta
+        calls = []
+
+        def factory(offset):
+            calls.append(offset)
+            return FixedOffsetTimezone(offset)
+
+        self.curs.tzinfo_factory = factory
+        self.curs.execute("set time zone interval '+02:00'")
+        self.curs.execute("""
+            select '2010-05-03 10:20:30+02'::timestamptz + x * '1 day'::interval
+            from generate_series(1, 100) x""")
+        recs = self.curs.fetchall()
+        self.assertEqual(recs[0][0].utcoffset(), timedelta(hours=2))
+        self.assert_(recs[0][0].tzinfo is recs[-1][0].tzinfo)
+        self.assertEqual(calls, [120])
+
+    @skip_before_python(3, 7)
+    def test_tzinfo_factory_timezone(self):
+        from datetime import timedelta, timezone
+        self.curs.tzinfo_factory = timezone
+        self.curs.execute("""
+            select '10:20:30+02'::timetz, '10:20:30+00'::timetz,
+                '10:20:30-05:30'::timetz""")
+        t1, t2, t3 = self.curs.fetchone()
+        self.assertEqual(type(t1.tzinfo), timezone)
+        self.assertEqual(t1.utcoffset(), timedelta(hours=2))
+        self.assert_(t2.tzinfo is timezone.utc)
+        self.assertEqual(t3.utcoffset(), -timedelta(hours=5, minutes=30))
+
     def test_type_roundtrip_time(self):
         from datetime import time
         tm = self._test_type_roundtrip(time(10, 20, 30))
@@ -446,6 +502,18 @@ class DatetimeTests(ConnectingTestCase, CommonDatetimeTestsMixin):
         cur.execute("select '1 day 2 hours'::interval")
         self.assertRaises(psycopg2.NotSupportedError, cur.fetchone)
 
+    def test_interval_binary(self):
+        from datetime import timedelta
+        cur = self.conn.cursor()
+        cur.execute("""
+            declare bc binary cursor for
+            select '1 mon 2 days 03:04:05.678'::interval,
+                '-1 days -00:00:01'::interval, null::interval""")
+        cur.execute("fetch all from bc")
+        self.assertEqual(cur.fetchone(), (
+            timedelta(days=32, hours=3, minutes=4, seconds=5.678),
+            timedelta(days=-1, seconds=-1), None))
+
 
 # Only run the datetime tests if psycopg was compiled with support.
 if not hasattr(psycopg2.extensions, 'PYDATETIME'):
@@ -657,6 +725,48 @@ class FromTicksTestCase(unittest.TestCase):
             time(0, 11, 59, 999920))
 
 
+class DatetimeQuotingTests(unittest.TestCase):
+    def _check(self, obj, cast):
+        from psycopg2.extensions import adapt
+        self.assertEqual(adapt(obj).getquoted(),
+            ("'%s'::%s" % (obj.isoformat(), cast)).encode('ascii'))
+
+    def test_quote_as_isoformat(self):
+        from datetime import date, time, datetime
+        tz = FixedOffsetTimezone(-90)
+        self._check(date(1, 2, 3), 'date')
+        self._check(time(1, 2, 3), 'time')
+        self._check(time(1, 2, 3, 4, tzinfo=tz), 'timetz')
+        self._check(datetime(2000, 1, 2, 3, 4, 5), 'timestamp')
+        self._check(datetime(2000, 1, 2, 3, 4, 5, 6, tzinfo=tz), 'timestamptz')
+        self._check(datetime(9999, 1, 2, tzinfo=FixedOffsetTimezone()),
+            'timestamptz')
+
+    def test_quote_tzinfo_offset(self):
+        from datetime import datetime, timedelta, tzinfo
+
+        class SummerTime(tzinfo):
+            def utcoffset(self, dt):
+                return timedelta(hours=dt.month in (6, 7, 8) and 2 or 1)
+
+        for month in (1, 7):
+            self._check(datetime(2000, month, 1, tzinfo=SummerTime()),
+                'timestamptz')
+
+        class Naive(tzinfo):
+            def utcoffset(self, dt):
+                return None
+
+        self._check(datetime(2000, 1, 1, tzinfo=Naive()), 'timestamptz')
+
+        class Wrong(tzinfo):
+            def utcoffset(self, dt):
+                return timedelta(days=2)
+
+        self.assertRaises(ValueError, psycopg2.extensions.adapt(
+            datetime(2000, 1, 1, tzinfo=Wrong())).getquoted)
+
+
 class FixedOffsetTimezoneTests(unittest.TestCase):
 
     def test_init_with_no_args(self):
@@ -61,6 +61,22 @@ class NetworkingTestCase(testutils.ConnectingTestCase):
         self.assert_(isinstance(obj, ip.IPv6Interface), repr(obj))
         self.assertEquals(obj, ip.ip_interface('::ffff:102:300/128'))
 
+    def test_inet_cast_leading_zeros(self):
+        # the octets with leading zeros are left for ipaddress to judge
+        import ipaddress as ip
+        from psycopg2._ipaddress import _casters
+        cur = self.conn.cursor()
+        psycopg2.extras.register_ipaddress(cur)
+        inet = _casters[0]
+
+        for s in [u'01.2.3.4', u'1.2.3.00/24', u'::ffff:1.02.3.4']:
+            try:
+                obj = ip.ip_interface(s)
+            except ValueError:
+                self.assertRaises(ValueError, inet, s, cur)
+            else:
+                self.assertEqual(inet(s, cur), obj)
+
     @testutils.skip_before_postgres(8, 2)
     def test_inet_array_cast(self):
         import ipaddress as ip
@@ -85,6 +101,23 @@ class NetworkingTestCase(testutils.ConnectingTestCase):
         cur.execute("select %s", [ip.ip_interface('::ffff:102:300/128')])
         self.assertEquals(cur.fetchone()[0], '::ffff:102:300/128')
 
+    def test_inet_roundtrip(self):
+        import ipaddress as ip
+        cur = self.conn.cursor()
+        psycopg2.extras.register_ipaddress(cur)
+
+        for s in ['0.0.0.0/0', '10.1.2.3/8', '255.255.255.255',
+                '::', '::1', '1::', '2001:db8::1/64', '1:0:0:2:0:0:0:3/100',
+                '1:2:3:4:5:6:7:8', '::ffff:1.2.3.4']:
+            obj = ip.ip_interface(s)
+            cur.execute("select %s::inet, %s::text::inet", [obj, s])
+            rv = cur.fetchone()
+            self.assertEqual(rv[0], obj)
+            self.assertEqual(rv[1], obj)
+            self.assert_(type(rv[1]) is type(obj), rv)
+            self.assertEqual(
+                cur.mogrify("%s", [obj]), ("'%s'" % obj).encode('ascii'))
+
     def test_cidr_cast(self):
         import ipaddress as ip
         cur = self.conn.cursor()
@@ -62,6 +62,19 @@ class QuotingTestCase(ConnectingTestCase):
         self.assertEqual(res, data)
         self.assert_(not self.conn.notices)
 
+    def test_string_escape_position(self):
+        # the strings are scanned 16 bytes or a word at a time: check the
+        # chars to escape in every position
+        curs = self.conn.cursor()
+        for c in ("'", "\\"):
+            for n in range(40):
+                for i in range(n):
+                    data = 'x' * i + c + 'y' * (n - i - 1)
+                    curs.execute("SELECT %s;", (data,))
+                    self.assertEqual(curs.fetchone()[0], data)
+
+        self.assert_(not self.conn.notices)
+
     def test_string_null_terminator(self):
         curs = self.conn.cursor()
         data = 'abcd\x01\x00cdefg'
@@ -97,6 +110,18 @@ class QuotingTestCase(ConnectingTestCase):
         self.assertEqual(res, data)
         self.assert_(not self.conn.notices)
 
+    @testutils.skip_before_postgres(9, 0)
+    def test_binary_hex(self):
+        data = bytes(bytearray(range(256))) * 3 + b"tail"
+        curs = self.conn.cursor()
+        for scs in ('on', 'off'):
+            curs.execute("set standard_conforming_strings to " + scs)
+            a = psycopg2.Binary(data)
+            a.prepare(self.conn)
+            self.assert_(b"5c5d5e5f" in a.getquoted())
+            curs.execute("SELECT %s::bytea;", (a,))
+            self.assertEqual(bytes(curs.fetchone()[0]), data)
+
     def test_unicode(self):
         curs = self.conn.cursor()
         curs.execute("SHOW server_encoding")
@@ -108,6 +108,18 @@ class SqlFormatTests(ConnectingTestCase):
         self.assertRaises(ValueError, sql.SQL("select {a!r};").format, a=10)
         self.assertRaises(ValueError, sql.SQL("select {a:<};").format, a=10)
 
+    def test_template_reused(self):
+        t = "select {} from {}"
+        for f, tbl in [('f1', 't1'), ('f2', 't2')]:
+            s = sql.SQL(t).format(sql.Identifier(f), sql.Identifier(tbl))
+            self.assertEqual(s.as_string(self.conn),
+                'select "%s" from "%s"' % (f, tbl))
+
+        for i in range(2):
+            self.assertRaises(IndexError, sql.SQL("select {0} {};").format)
+            self.assertRaises(ValueError,
+                sql.SQL("select {0} {};").format, 10, 20)
+
     def test_must_be_adaptable(self):
         class Foo(object):
             pass
@@ -368,6 +380,17 @@ class ComposedTest(ConnectingTestCase):
         self.assertEqual(i, sql.SQL('bar'))
         self.assertRaises(StopIteration, next, it)
 
+    def test_nested_subclass(self):
+        class MyIdentifier(sql.Identifier):
+            def as_string(self, context):
+                return 'my_' + self.string
+
+        obj = sql.Composed([sql.SQL("select "),
+            sql.Composed([MyIdentifier('foo'), sql.SQL(', '),
+                sql.Identifier('bar')]), sql.Placeholder('baz')])
+        self.assertEqual(obj.as_string(self.conn),
+            'select my_foo, "bar"%(baz)s')
+
 
 class PlaceholderTest(ConnectingTestCase):
     def test_class(self):
@@ -23,6 +23,7 @@
 # License for more details.
 
 import decimal
+import gc
 
 import sys
 from functools import wraps
@@ -51,6 +52,17 @@ class TypesBasicTests(ConnectingTestCase):
         self.failUnless(self.execute("SELECT %s AS foo", (s,)) == s,
                         "wrong unicode quoting: " + s)
 
+    def testUnicodeLengths(self):
+        # ascii and non-ascii strings around the fast path block sizes
+        from psycopg2.extensions import UNICODE, register_type
+        register_type(UNICODE, self.conn)
+        for n in (0, 1, 7, 8, 15, 16, 17, 31, 32, 33, 100):
+            for tail in (u"", u"\xe8", u"\u20ac", u"\U0001f600"):
+                s = u"x" * n + tail
+                self.assertEqual(self.execute("SELECT %s AS foo", (s,)), s)
+                s = tail + u"x" * n
+                self.assertEqual(self.execute("SELECT %s AS foo", (s,)), s)
+
     def testNumber(self):
         s = self.execute("SELECT %s AS foo", (1971,))
         self.failUnless(s == 1971, "wrong integer quoting: " + str(s))
@@ -80,6 +92,28 @@ class TypesBasicTests(ConnectingTestCase):
         self.failUnless(type(s) == decimal.Decimal,
                         "wrong decimal conversion: " + repr(s))
 
+    def testDec2Number(self):
+        curs = self.conn.cursor()
+        psycopg2.extensions.register_type(
+            psycopg2.extensions.DEC2NUMBER, curs)
+        psycopg2.extensions.register_type(
+            psycopg2.extensions.DEC2NUMBERARRAY, curs)
+        curs.execute("""select 10::numeric(10,0), -1.50::numeric(10,2),
+            'NaN'::numeric, 123456789012345678901234567890::numeric,
+            '{1,2.5,NULL}'::numeric[]""")
+        r = curs.fetchone()
+        self.assertEqual(r[0], 10)
+        self.assert_(isinstance(r[0], (int, long)))
+        self.assertEqual(r[1], -1.5)
+        self.assert_(isinstance(r[1], float))
+        self.assert_(r[2] != r[2])
+        self.assertEqual(r[3], long(123456789012345678901234567890))
+        self.assertEqual(r[4], [1, 2.5, None])
+
+        # other cursors are not affected
+        self.assert_(isinstance(self.execute("select 10::numeric"),
+            decimal.Decimal))
+
     def testFloatNan(self):
         try:
             float("nan")
@@ -116,6 +150,22 @@ class TypesBasicTests(ConnectingTestCase):
             buf = self.execute("SELECT %s::bytea AS foo", (b,))
             self.assertEqual(s, buf.tobytes())
 
+    def testBinaryFormat(self):
+        s = bytes(bytearray(range(256))) * 10
+        cur = self.conn.cursor()
+        cur.execute("""
+            declare bc binary cursor for
+            select %s::bytea, null::bytea""", (psycopg2.Binary(s),))
+        cur.execute("fetch all from bc")
+        buf, null = cur.fetchone()
+        self.assertEqual(null, None)
+
+        # the value outlives the cursor and its result
+        cur.close()
+        del cur
+        gc.collect()
+        self.assertEqual(s, bytes(buf))
+
     def testBinaryNone(self):
         b = psycopg2.Binary(None)
         buf = self.execute("SELECT %s::bytea AS foo", (b,))
@@ -150,6 +200,105 @@ class TypesBasicTests(ConnectingTestCase):
         s = self.execute("SELECT %s AS foo", (['one', 'two', 'three'],))
         self.failUnlessEqual(s, ['one', 'two', 'three'])
 
+    def testArrayLiteral(self):
+        curs = self.conn.cursor()
+        for a, t in [
+                ([1, None, -2], 'integer[]'),
+                ([2 ** 40, 1], 'bigint[]'),
+                ([[1.5, 2], [None, -3.25]], 'numeric[]'),
+                ([1.5, float('inf')], 'double precision[]'),
+                (['a', None, 'b"c', '\\', "'", 'NULL'], 'text[]')]:
+            curs.execute("select %s, pg_typeof(%s)::text", (a, a))
+            r = curs.fetchone()
+            self.assertEqual(r[0], a)
+            self.assertEqual(r[1], t)
+
+    def testArrayLiteralSjis(self):
+        # in sjis the second byte of a char can be a backslash
+        from psycopg2.extensions import UNICODE, UNICODEARRAY, register_type
+        curs = self.conn.cursor()
+        curs.execute("SHOW server_encoding")
+        if curs.fetchone()[0] != "UTF8":
+            return self.skipTest("the server encoding is not UTF8")
+
+        self.conn.set_client_encoding('SJIS')
+        register_type(UNICODE, self.conn)
+        register_type(UNICODEARRAY, self.conn)
+        a = [u'\u8868', u'\u30bd', u'a"\u8868\\']
+        curs.execute("select %s, pg_typeof(%s)::text", (a, a))
+        self.assertEqual(curs.fetchone(), (a, 'text[]'))
+
+    def testSqlInArray(self):
+        from psycopg2.extensions import SQL_IN
+        curs = self.conn.cursor()
+        for seq in ([1, -2, None], ['a', 'b"c', None, 'NULL', '\\', "'"]):
+            curs.execute("select %s = any(%s), %s",
+                (seq[0], SQL_IN(seq, array=True), SQL_IN(seq, array=True)))
+            self.assertEqual(curs.fetchone(), (True, seq))
+
+        curs.execute("select 1 = any(%s)", (SQL_IN([], array=True),))
+        self.assertEqual(curs.fetchone()[0], False)
+
+        # the untyped arrays take the type of the other operand
+        curs.execute("select 'a'::text = any(%s), now() = any(%s)",
+            (SQL_IN([], array=True), SQL_IN([None], array=True)))
+        self.assertEqual(curs.fetchone(), (False, None))
+
+        curs.execute("select %s = any(%s)", (2 ** 70, SQL_IN((2 ** 70,), array=True)))
+        self.assertEqual(curs.fetchone()[0], True)
+        curs.execute("select %s in %s", (2, SQL_IN(iter([1, 2]))))
+        self.assertEqual(curs.fetchone()[0], True)
+
+    def testSqlInArraySjis(self):
+        from psycopg2.extensions import SQL_IN, UNICODE, register_type
+        curs = self.conn.cursor()
+        curs.execute("SHOW server_encoding")
+        if curs.fetchone()[0] != "UTF8":
+            return self.skipTest("the server encoding is not UTF8")
+
+        self.conn.set_client_encoding('SJIS')
+        register_type(UNICODE, self.conn)
+        seq = [u'\u8868', u'\u30bd', u'a"\u8868\\']
+        for s in seq:
+            curs.execute("select %s = any(%s)",
+                (s, SQL_IN(seq, array=True)))
+            self.assertEqual(curs.fetchone()[0], True)
+        curs.execute("select array_length(%s, 1)", (SQL_IN(seq, array=True),))
+        self.assertEqual(curs.fetchone()[0], 3)
+
+    def testArrayScalars(self):
+        s = self.execute("SELECT '{{1,2},{3,NULL}}'::int4[]")
+        self.assertEqual(s, [[1, 2], [3, None]])
+        s = self.execute("SELECT '{-9223372036854775808}'::int8[]")
+        self.assertEqual(s, [-9223372036854775808])
+        s = self.execute("SELECT '{1.5,-Infinity}'::float8[]")
+        self.assertEqual(s, [1.5, float('-inf')])
+        s = self.execute("SELECT '{t,f,NULL}'::bool[]")
+        self.assertEqual(s, [True, False, None])
+        s = self.execute("""SELECT '{a,"b,c",NULL,"NULL","\\\\"}'::text[]""")
+        self.assertEqual(s, ['a', 'b,c', None, 'NULL', '\\'])
+
+    def testArrayPyArray(self):
+        from array import array
+        curs = self.conn.cursor()
+        for t in (psycopg2.extensions.INTEGERARRAY_PYARRAY,
+                  psycopg2.extensions.LONGINTEGERARRAY_PYARRAY,
+                  psycopg2.extensions.FLOATARRAY_PYARRAY):
+            psycopg2.extensions.register_type(t, curs)
+
+        curs.execute("""SELECT '{1,2,3}'::int4[], '{1,2,3}'::int8[],
+            '{1.5,2,3}'::float8[], '{}'::int4[], '{1,NULL}'::int4[],
+            '{{1},{2}}'::int8[]""")
+        r = curs.fetchone()
+        for a in r[:4]:
+            self.assert_(isinstance(a, array), a)
+        self.assertEqual(list(r[0]), [1, 2, 3])
+        self.assertEqual(list(r[1]), [1, 2, 3])
+        self.assertEqual(list(r[2]), [1.5, 2.0, 3.0])
+        self.assertEqual(list(r[3]), [])
+        self.assertEqual(r[4], [1, None])
+        self.assertEqual(r[5], [[1], [2]])
+
     def testEmptyArrayRegression(self):
         # ticket #42
         import datetime
@@ -341,6 +490,17 @@ class TypesBasicTests(ConnectingTestCase):
         o2 = self.execute("SELECT %s::bytea AS foo", (o1,))
         self.assertEqual(b'x', o2[0])
 
+    @testutils.skip_before_postgres(9, 0)
+    def testByteaHexLengths(self):
+        # values long enough to go through the block decoder and to be
+        # decoded with the GIL released, plus the leftovers of the blocks
+        self.conn.cursor().execute("set bytea_output to hex")
+        data = bytes(bytearray(range(256)))
+        for n in (1, 15, 16, 31, 32, 33, 1000, 100001):
+            s = (data * (n // 256 + 1))[:n]
+            o = self.execute("SELECT %s::bytea AS foo", (psycopg2.Binary(s),))
+            self.assertEqual(s, bytes(o))
+
     def testNegNumber(self):
         d1 = self.execute("select -%s;", (decimal.Decimal('-1.0'),))
         self.assertEqual(1, d1)
@@ -351,6 +511,20 @@ class TypesBasicTests(ConnectingTestCase):
         l1 = self.execute("select -%s;", (long(-1),))
         self.assertEqual(1, l1)
 
+    def testNumberLimits(self):
+        for v in ['0', '-32768', '32767']:
+            self.assertEqual(self.execute("select %s::int2" % v), int(v))
+        for v in ['-2147483648', '2147483647']:
+            self.assertEqual(self.execute("select %s::int4" % v), int(v))
+        for v in ['-9223372036854775808', '9223372036854775807']:
+            self.assertEqual(self.execute("select %s::int8" % v), long(v))
+        self.assertEqual(self.execute("select 1.5::float8"), 1.5)
+        self.assertEqual(self.execute("select -1e300::float8"), -1e300)
+        self.assertEqual(self.execute("select '{1,NULL,-3}'::int8[]"),
+            [1, None, -3])
+        self.assertEqual(self.execute("select '{1.5,NULL,-3}'::float8[]"),
+            [1.5, None, -3.0])
+
     def testGenericArray(self):
         a = self.execute("select '{1, 2, 3}'::int4[]")
         self.assertEqual(a, [1, 2, 3])
@@ -372,6 +546,16 @@ class TypesBasicTests(ConnectingTestCase):
         a = self.execute("select '{1, 2, NULL}'::int4[]")
         self.assertEqual(a, [2, 4, 'nada'])
 
+    def testArrayCasterBadBase(self):
+        # the base is not a typecaster: the array caster is called as a
+        # Python function, with its own base
+        for base in (object(), None):
+            array = psycopg2.extensions.new_type((1007,), "INT4ARRAY",
+                psycopg2.extensions.INTEGERARRAY, base)
+            psycopg2.extensions.register_type(array, self.conn)
+            a = self.execute("select '{1, 2, 3}'::int4[]")
+            self.assertEqual(a, [1, 2, 3])
+
     @testutils.skip_before_postgres(8, 2)
     def testNetworkArray(self):
         # we don't know these types, but we know their arrays
@@ -457,6 +641,110 @@ class AdaptSubclassTest(unittest.TestCase):
         finally:
             del psycopg2.extensions.adapters[A, psycopg2.extensions.ISQLQuote]
 
+    def test_adapt_registry_changes(self):
+        from psycopg2.extensions import adapt, register_adapter, AsIs
+        ext = psycopg2.extensions
+
+        class A(object):
+            pass
+
+        class B(A):
+            pass
+
+        self.assertRaises(psycopg2.ProgrammingError, adapt, B())
+        register_adapter(A, lambda a: AsIs("a"))
+        try:
+            self.assertEqual(b"a", adapt(B()).getquoted())
+            register_adapter(B, lambda b: AsIs("b"))
+            self.assertEqual(b"b", adapt(B()).getquoted())
+            ext.adapters.pop((B, ext.ISQLQuote))
+            self.assertEqual(b"a", adapt(B()).getquoted())
+        finally:
+            del ext.adapters[A, ext.ISQLQuote]
+        self.assertRaises(psycopg2.ProgrammingError, adapt, B())
+
+        orig = ext.adapters[int, ext.ISQLQuote]
+        register_adapter(int, lambda i: AsIs("int"))
+        try:
+            self.assertEqual(b"int", adapt(10).getquoted())
+        finally:
+            register_adapter(int, orig)
+        self.assertEqual(b"10", adapt(10).getquoted())
+
+    @testutils.skip_before_python(3, 9)
+    def test_adapt_registry_ior(self):
+        from psycopg2.extensions import adapt, register_adapter, AsIs
+        ext = psycopg2.extensions
+
+        class A(object):
+            pass
+
+        register_adapter(A, lambda a: AsIs("a"))
+        try:
+            self.assertEqual(b"a", adapt(A()).getquoted())
+            ext.adapters |= {(A, ext.ISQLQuote): lambda a: AsIs("b")}
+            self.assertEqual(b"b", adapt(A()).getquoted())
+        finally:
+            del ext.adapters[A, ext.ISQLQuote]
+
+    def test_adapter_removed_by_conform(self):
+        from psycopg2.extensions import adapt, register_adapter, AsIs
+        ext = psycopg2.extensions
+
+        class A(object):
+            pass
+
+        class B(A):
+            def __conform__(self, proto):
+                ext.adapters.pop((A, ext.ISQLQuote), None)
+                gc.collect()
+
+        register_adapter(A, lambda a: AsIs("a"))
+        self.assertEqual(b"a", adapt(B()).getquoted())
+        self.assertRaises(psycopg2.ProgrammingError, adapt, B())
+
+    def test_conform_added_later(self):
+        from psycopg2.extensions import adapt, AsIs
+
+        class A(object):
+            pass
+
+        a = A()
+        self.assertRaises(psycopg2.ProgrammingError, adapt, a)
+        a.__conform__ = lambda proto: AsIs("obj")
+        self.assertEqual(b"obj", adapt(a).getquoted())
+        A.__conform__ = lambda self, proto: AsIs("cls")
+        self.assertEqual(b"cls", adapt(A()).getquoted())
+
+    def test_sql_in(self):
+        from psycopg2.extensions import adapt, SQL_IN
+
+        self.assertEqual(adapt((1, None, 'a')).getquoted(), b"(1, NULL, 'a')")
+        self.assertEqual(adapt(()).getquoted(), b"()")
+        self.assertEqual(adapt(((1, 2), [3])).getquoted(),
+            b"((1, 2), '{3}'::int4[])")
+        self.assertEqual(SQL_IN([1, -2, None], array=True).getquoted(),
+            b"'{1,-2,NULL}'::int8[]")
+        self.assertEqual(SQL_IN([], array=True).getquoted(), b"'{}'")
+        self.assertEqual(SQL_IN(['a', "b'c", None], array=True).getquoted(),
+            b"""'{"a","b''c",NULL}'::text[]""")
+        self.assertEqual(SQL_IN([1.5, None], array=True).getquoted(),
+            b"'{1.5,NULL}'::numeric[]")
+
+    def test_list_literal(self):
+        from psycopg2.extensions import adapt
+
+        self.assertEqual(adapt([1, None]).getquoted(), b"'{1,NULL}'::int4[]")
+        self.assertEqual(adapt([[1.5], [-2]]).getquoted(),
+            b"'{{1.5},{-2}}'::numeric[]")
+        self.assertEqual(adapt([float('nan')]).getquoted(),
+            b"'{NaN}'::float8[]")
+        self.assertEqual(adapt(['a', None]).getquoted(),
+            b"""'{"a",NULL}'::text[]""")
+        self.assertEqual(adapt([[1], [2, 3]]).getquoted(),
+            b"ARRAY['{1}'::int4[],'{2,3}'::int4[]]")
+        self.assertEqual(adapt([1, 'a']).getquoted(), b"ARRAY[1,'a']")
+
     def test_conform_subclass_precedence(self):
 
         import psycopg2.extensions as ext
@@ -50,6 +50,21 @@ class TypesExtrasTests(ConnectingTestCase):
         s = self.execute("SELECT NULL::uuid AS foo")
         self.failUnless(s is None)
 
+    @skip_if_no_uuid
+    def testUUIDCast(self):
+        import uuid
+        psycopg2.extras.register_uuid()
+        for u in [uuid.UUID(int=0), uuid.UUID(int=(1 << 128) - 1),
+                  uuid.UUID('9c6d5a77-7256-457e-9461-347b4358e350')]:
+            s = self.execute("SELECT %s::text::uuid AS foo", (str(u),))
+            self.assertEqual(s, u)
+            self.assert_(type(s) is uuid.UUID)
+            self.assertEqual(str(s), str(u))
+            self.assertEqual(hash(s), hash(u))
+            self.assertEqual(
+                self.conn.cursor().mogrify("%s", (u,)),
+                ("'%s'::uuid" % u).encode('ascii'))
+
     @skip_if_no_uuid
     def testUUIDARRAY(self):
         import uuid
@@ -226,6 +241,33 @@ class HstoreTestCase(ConnectingTestCase):
         ko('"a=>"1"')
         ko('"a"=>"1", "b"=>NUL')
 
+    def test_parse_c(self):
+        # the C typecaster accepts the same input of parse()
+        from psycopg2.extras import HstoreAdapter
+        from psycopg2._psycopg import PYHSTORE
+        cur = self.conn.cursor()
+
+        for s in ['', '"a"=>"1", "b"=>NULL', '"a"  => "1" , "b"  =>  "2"',
+                '"a"=>"1",', '"a"=>"1" ,\f"b"=>"2"', r'"a\\\""=>"1"']:
+            self.assertEqual(PYHSTORE(s, cur), HstoreAdapter.parse(s, None))
+
+        for s in [' "a"=>"1"', '"a"=>"1" ', '"a"=>"1"\n', ' ', '"a"=>NULL ',
+                '"a\\\n"=>"1"', '"a"=>"1" x']:
+            self.assertRaises(psycopg2.InterfaceError,
+                HstoreAdapter.parse, s, None)
+            self.assertRaises(psycopg2.InterfaceError, PYHSTORE, s, cur)
+
+    @skip_if_no_hstore
+    def test_cast(self):
+        from psycopg2.extras import register_hstore, HstoreAdapter
+        register_hstore(self.conn)
+        cur = self.conn.cursor()
+
+        for s in ['', '"a"=>"1", "b"=>NULL', r'"a\\"=>"\"", "\""=>"2"',
+                '"a"=>"\'", "\'"=>"2"', r'"a\\\\\""=>"1"']:
+            cur.execute("select %s::hstore", (s,))
+            self.assertEqual(cur.fetchone()[0], HstoreAdapter.parse(s, None))
+
     @skip_if_no_hstore
     def test_register_conn(self):
         from psycopg2.extras import register_hstore
@@ -521,6 +563,18 @@ class AdaptTypeTestCase(ConnectingTestCase):
            '^_`abcdefghijklmnopqrstuvwxyz{|}~\x7f")',
            [None, ''.join(map(chr, range(1, 128)))])
 
+    def test_cast_tokens(self):
+        from psycopg2.extras import CompositeCaster
+        c = CompositeCaster('pair', 0, [('a', 25), ('b', 25)])
+        curs = self.conn.cursor()
+
+        for s in ['(,)', '(,"")', '(10,"""")', '(10,",")', r'(10,"\\")',
+                '(10,"(20,""(30,40)"")")', '(,"(,""(a\nb\tc)"")")']:
+            self.assertEqual(c.typecaster(s, curs), c.make(c.tokenize(s)))
+
+        self.assertRaises(psycopg2.DataError, c.typecaster, '(1,2,3)', curs)
+        self.assertRaises(psycopg2.InterfaceError, c.typecaster, '(1,"2)', curs)
+
     @skip_if_no_composite
     def test_cast_composite(self):
         oid = self._create_type("type_isd",
@@ -1015,6 +1069,28 @@ class JsonTestCase(ConnectingTestCase):
         self.assertEqual(data['a'], 100)
         self.assertEqual(data['b'], None)
 
+    def test_builtin_parser(self):
+        json = psycopg2.extras.json
+        curs = self.conn.cursor()
+        for s in [
+                '{"a": [1, -2, 3.5, 1e300, 12345678901234567890]}',
+                '[true, false, null, "", {}, []]',
+                r'"\"\\\/\b\f\n\r\t\u00e8\u20ac\ud83d\ude00"',
+                u'"\u2603 snowman"', '  "spaces"  ', '-0']:
+            curs.execute("select %s::json", (s,))
+            self.assertEqual(curs.fetchone()[0], json.loads(s))
+
+        curs.execute("select ('{\"key\": ' || x || '}')::json "
+            "from generate_series(1, 2) x")
+        (d1,), (d2,) = curs.fetchall()
+        self.assert_(list(d1)[0] is list(d2)[0])
+
+        # the errors are the same of json.loads()
+        from psycopg2._psycopg import PYJSON
+        for s in ['', '{', '[1,', '{"a":1,}', 'tru', '"\\x"', '[] x']:
+            self.assertRaises(ValueError, json.loads, s)
+            self.assertRaises(ValueError, PYJSON, s, curs)
+
     def test_str(self):
         snowman = u"\u2603"
         obj = {'a': [1, 2, snowman]}
@@ -1465,6 +1541,18 @@ class RangeCasterTestCase(ConnectingTestCase):
             self.assert_(r.lower_inf)
             self.assert_(r.upper_inf)
 
+    def test_cast_literals(self):
+        from psycopg2._range import int4range_caster, daterange_caster
+        cur = self.conn.cursor()
+        for caster, s in [
+                (int4range_caster, '[1,10)'), (int4range_caster, '(,-5]'),
+                (daterange_caster, '[-infinity,2019-01-01)'),
+                (daterange_caster, '["2019-01-01",infinity]')]:
+            self.assertEqual(caster.typecaster(s, cur), caster.parse(s, cur))
+
+        self.assertRaises(psycopg2.InterfaceError,
+            int4range_caster.typecaster, '[1,10', cur)
+
     def test_cast_numbers(self):
         from psycopg2.extras import NumericRange
         cur = self.conn.cursor()